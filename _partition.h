@@ -0,0 +1,51 @@
+
+#ifndef __IPARTITION_H__
+#define __IPARTITION_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "partition.h"
+
+// fast inline version without argument checking
+
+struct partition {
+    partition_row_t *rows;      // all rows, in partition order
+    size_t          *starts;    // 2^bits + 1 partition starts in rows
+    uint32_t        bits;
+};
+
+// return the mixed value of hash used to select partitions (multiplicative
+// hashing by 2^64 / golden ratio).
+static inline uint64_t _partition_mix( uint64_t hash )
+{
+    return hash * 0x9e3779b97f4a7c15;
+}
+
+static inline size_t _partition_index( uint64_t hash, uint32_t bits )
+{
+    return ( bits ) ? (size_t)(_partition_mix( hash ) >> (64 - bits)) : 0;
+}
+
+// return a table index in [0, 2^table_bits[ for a hash in a partition made
+// with bits, using the mixed hash bits that follow the partition bits.
+static inline size_t _partition_slot( uint64_t hash, uint32_t bits,
+                                      uint32_t table_bits )
+{
+    return (size_t)((_partition_mix( hash ) << bits) >> (64 - table_bits));
+}
+
+static inline size_t _partition_count( const partition_t *partition )
+{
+    return (size_t)1 << partition->bits;
+}
+
+static inline const partition_row_t *_partition_rows(
+                                            const partition_t *partition,
+                                            size_t index, size_t *lenp )
+{
+    *lenp = partition->starts[index+1] - partition->starts[index];
+    return &partition->rows[ partition->starts[index] ];
+}
+
+#endif /* __IPARTITION_H__ */
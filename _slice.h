@@ -9,6 +9,7 @@
 
 struct slice {
     vector_t    *vector;
+    const allocator_t *allocator;   // for the slice header
     void        *use;       // allow checking actual types and/or private data
     size_t      start;
     size_t      len;
@@ -74,8 +75,28 @@ static inline void _pointer_slice_write_item_at( slice_t *slice, size_t index,
     _pointer_vector_write_item_at( slice->vector, slice->start + index, data );
 }
 
+// copy-on-write: before modifying a slice whose array is shared, copy the
+// slice items at the beginning of a new array that the slice owns alone. The
+// slice capacity is unchanged, or number items if larger.
+static inline bool _slice_make_private( slice_t *slice, size_t number )
+{
+    if ( ! _vector_is_shared( slice->vector ) ) return true;
+
+    size_t cap = _slice_cap( slice );
+    vector_t *vector = vector_unshare( slice->vector, slice->start, slice->len,
+                                       ( number > cap ) ? number : cap );
+    if ( NULL == vector ) {
+        return false;
+    }
+    slice->vector = vector;
+    slice->start = 0;
+    return true;
+}
+
 static inline bool _slice_make_room( slice_t *slice )
 {
+    if ( ! _slice_make_private( slice, slice->len + 1 ) ) return false;
+
     if ( slice->len >= _slice_cap( slice ) ) {
         vector_t *vector = vector_grow( slice->vector );
         if ( NULL == vector ) {
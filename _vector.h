@@ -5,36 +5,72 @@
 #include <stddef.h>
 #include <stdint.h>
 #include <string.h>
+#include <stdbool.h>
 
 #include "vector.h"
 
 // fast inline version without argument checking
 
+// type of the inline data area, giving it the largest fundamental alignment
+typedef union {
+    long double ld;
+    uint64_t    u;
+    void        *p;
+} vector_inline_t;
+
 struct vector {
-    void    *data;
+    void    *data;          // inline_data or a separate allocation
+    const allocator_t *allocator;   // for the header and data
+    size_t  offset;         // data offset in its allocated block
+    data_free_fct data_free;    // releases an adopted buffer, or NULL
     size_t  ref_count;
     size_t  item_size;
+    size_t  stride;         // distance between items, at least item_size
+    size_t  alignment;      // data alignment, or 0 for the malloc alignment
     size_t  number;
+    size_t  growth;         // capacity growth in percent (e.g. 150 for x1.5)
+    size_t  mapped;         // size of the data mapping, if VECTOR_MAPPED
+    size_t  inline_size;    // size of inline_data in bytes
+    unsigned int flags;     // VECTOR_MAPPED and mapping options
+    vector_inline_t inline_data[];  // data allocated with the header
 };
 
+static inline bool _vector_is_inline( const vector_t *vector )
+{
+    return vector->data == (void *)vector->inline_data;
+}
+
+// the reference counter is read atomically if other threads may update it
+static inline size_t _vector_references( const vector_t *vector )
+{
+    if ( vector->flags & VECTOR_ATOMIC )
+        return __atomic_load_n( &vector->ref_count, __ATOMIC_ACQUIRE );
+    return vector->ref_count;
+}
+
+static inline bool _vector_is_shared( const vector_t *vector )
+{
+    return _vector_references( vector ) > 1;
+}
+
 static inline void _vector_zero( vector_t *vector )
 {
-    memset( vector->data, 0, vector->item_size * vector->number );
+    memset( vector->data, 0, vector->stride * vector->number );
 }
 
 static inline void _vector_segment_zero( vector_t * vector,
                                          size_t start, size_t len )
 {
     if ( start + len <= vector->number ) {
-        memset( (void *)((char *)vector->data + vector->item_size * start), 0,
-                 vector->item_size * len );
+        memset( (void *)((char *)vector->data + vector->stride * start), 0,
+                 vector->stride * len );
     }
 }
 
 static inline uint8_t * _vector_index_ptr_at( const vector_t *vector,
                                               size_t index )
 {
-    return ((uint8_t *)vector->data + index * vector->item_size );
+    return ((uint8_t *)vector->data + index * vector->stride );
 }
 
 static inline void * _vector_item_at( const vector_t *vector, size_t index )
@@ -68,6 +104,11 @@ static inline size_t _vector_item_size( const vector_t * vector )
     return vector->item_size;
 }
 
+static inline size_t _vector_stride( const vector_t * vector )
+{
+    return vector->stride;
+}
+
 static inline size_t _vector_cap( const vector_t *vector )
 {
     return vector->number;
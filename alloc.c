@@ -0,0 +1,87 @@
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "alloc.h"
+
+static void *std_alloc( void *context, size_t size )
+{
+    (void)context;
+    return malloc( size );
+}
+
+static void *std_realloc( void *context, void *ptr,
+                          size_t old_size, size_t size )
+{
+    (void)context;
+    (void)old_size;
+    return realloc( ptr, size );
+}
+
+static void std_free( void *context, void *ptr, size_t size )
+{
+    (void)context;
+    (void)size;
+    free( ptr );
+}
+
+static const allocator_t std_allocator = {
+    std_alloc, std_realloc, std_free, NULL
+};
+
+static const allocator_t *default_alloc = &std_allocator;
+
+extern const allocator_t *malloc_allocator( void )
+{
+    return &std_allocator;
+}
+
+extern int set_default_allocator( const allocator_t *allocator )
+{
+    if ( NULL == allocator ) {
+        default_alloc = &std_allocator;
+        return 0;
+    }
+    if ( NULL == allocator->alloc ) return -1;
+
+    default_alloc = allocator;
+    return 0;
+}
+
+extern const allocator_t *default_allocator( void )
+{
+    return default_alloc;
+}
+
+extern void *allocator_alloc( const allocator_t *allocator, size_t size )
+{
+    if ( NULL == allocator ) allocator = default_alloc;
+    return allocator->alloc( allocator->context, size );
+}
+
+extern void *allocator_realloc( const allocator_t *allocator, void *ptr,
+                                size_t old_size, size_t size )
+{
+    if ( NULL == allocator ) allocator = default_alloc;
+    if ( NULL == ptr ) return allocator->alloc( allocator->context, size );
+
+    if ( allocator->realloc ) {
+        return allocator->realloc( allocator->context, ptr, old_size, size );
+    }
+    void *new_ptr = allocator->alloc( allocator->context, size );
+    if ( NULL != new_ptr ) {
+        memcpy( new_ptr, ptr, ( old_size < size ) ? old_size : size );
+        if ( allocator->free ) allocator->free( allocator->context,
+                                                ptr, old_size );
+    }
+    return new_ptr;
+}
+
+extern void allocator_free( const allocator_t *allocator,
+                            void *ptr, size_t size )
+{
+    if ( NULL == allocator ) allocator = default_alloc;
+    if ( NULL != ptr && allocator->free ) {
+        allocator->free( allocator->context, ptr, size );
+    }
+}
@@ -0,0 +1,70 @@
+
+#ifndef __ALLOC_H__
+#define __ALLOC_H__
+
+#include <stddef.h>
+
+/*
+    Allocators give containers their memory: vectors and slices, maps (table
+    and collision entries), heaps, fifo and queue (headers and list entries)
+    make all their internal allocations through the allocator given when they
+    are created, or through the default allocator, which is malloc unless it
+    is replaced by calling set_default_allocator. With the malloc allocator,
+    fifo, queue and map entries are taken from shared slab caches instead, to
+    avoid a malloc and a free per entry (see slab.h).
+
+    An allocator is a set of functions, which receive the allocator context
+    as first argument (e.g. a memory pool), and the allocation size when
+    memory is re-allocated or freed, so that allocators do not have to keep
+    track of block sizes:
+
+    - alloc must return a block of at least size bytes, aligned as malloc
+      does, or NULL if no memory is available. It is required.
+    - realloc must behave as the standard realloc, given the current block
+      size old_size. If it is NULL, a new block is allocated and the data is
+      copied.
+    - free must release a block of size bytes. If it is NULL, blocks are
+      never freed individually (region mode), and the memory is expected to be
+      released all at once by the allocator owner.
+
+    Containers keep a pointer to their allocator, which must stay valid until
+    they are all freed. Allocators do not need to be thread safe: containers
+    call them only from the thread using the container, except for maps
+    using the default malloc allocator, whose bulk operations allocate from
+    multiple threads (see new_map_from_arrays and map_merge).
+*/
+
+typedef struct {
+    void    *(*alloc)( void *context, size_t size );
+    void    *(*realloc)( void *context, void *ptr,
+                         size_t old_size, size_t size );
+    void    (*free)( void *context, void *ptr, size_t size );
+    void    *context;
+} allocator_t;
+
+// return the allocator calling malloc, realloc and free.
+extern const allocator_t *malloc_allocator( void );
+
+// set the allocator used by all containers created afterwards without an
+// explicit allocator (existing containers keep their allocator). If the
+// argument is NULL, the malloc allocator is restored. It returns 0 in case of
+// success or -1 if the allocator has no alloc function. It is not thread safe
+// and should be called before creating containers.
+extern int set_default_allocator( const allocator_t *allocator );
+
+// return the current default allocator.
+extern const allocator_t *default_allocator( void );
+
+// allocate, re-allocate and free memory with the given allocator, or with the
+// default allocator if the argument allocator is NULL. allocator_realloc and
+// allocator_free must be given the current block size, which is ignored by
+// the malloc allocator.
+extern void *allocator_alloc( const allocator_t *allocator, size_t size );
+
+extern void *allocator_realloc( const allocator_t *allocator, void *ptr,
+                                size_t old_size, size_t size );
+
+extern void allocator_free( const allocator_t *allocator,
+                            void *ptr, size_t size );
+
+#endif /* __ALLOC_H__ */
@@ -0,0 +1,166 @@
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "arena.h"
+
+// all allocations are aligned as malloc does on common 64-bit platforms
+#define ARENA_ALIGNMENT     16
+
+typedef struct arena_block {
+    struct arena_block  *next;
+    size_t              size;   // bytes available after the block header
+} arena_block_t;
+
+struct arena {
+    allocator_t     allocator;  // with this arena as context
+    arena_block_t   *first;     // blocks in order of use
+    arena_block_t   *current;   // block in use, blocks after it are free
+    uint8_t         *top;       // next allocation in current block
+    uint8_t         *end;       // end of current block
+    uint8_t         *last;      // last allocation, which can grow in place
+    size_t          block_size;
+    size_t          used;       // bytes allocated since last reset
+    size_t          size;       // total size of all blocks
+};
+
+static inline size_t align_size( size_t size )
+{
+    return ( size + ARENA_ALIGNMENT - 1 ) & ~(size_t)( ARENA_ALIGNMENT - 1 );
+}
+
+// the block data starts after the block header, rounded up to the alignment
+static inline uint8_t *block_data( arena_block_t *block )
+{
+    return (uint8_t *)block + align_size( sizeof(arena_block_t) );
+}
+
+static arena_block_t *new_block( arena_t *arena, size_t size )
+{
+    if ( size < arena->block_size ) size = arena->block_size;
+    arena_block_t *block = malloc( align_size( sizeof(arena_block_t) ) + size );
+    if ( NULL == block ) return NULL;
+
+    block->next = NULL;
+    block->size = size;
+    arena->size += size;
+    return block;
+}
+
+static inline void use_block( arena_t *arena, arena_block_t *block )
+{
+    arena->current = block;
+    arena->top = block_data( block );
+    arena->end = arena->top + block->size;
+}
+
+// move to the next free block if it is large enough, otherwise insert a new
+// block after the current one. Blocks are reused after a reset, in order.
+static bool next_block( arena_t *arena, size_t size )
+{
+    arena_block_t *block = arena->current->next;
+    if ( NULL == block || block->size < size ) {
+        block = new_block( arena, size );
+        if ( NULL == block ) return false;
+        block->next = arena->current->next;
+        arena->current->next = block;
+    }
+    use_block( arena, block );
+    return true;
+}
+
+static void *arena_alloc( void *context, size_t size )
+{
+    arena_t *arena = context;
+    size = align_size( size );
+    if ( size > (size_t)( arena->end - arena->top ) &&
+         ! next_block( arena, size ) ) return NULL;
+
+    arena->last = arena->top;
+    arena->top += size;
+    arena->used += size;
+    return arena->last;
+}
+
+static void *arena_realloc( void *context, void *ptr,
+                            size_t old_size, size_t size )
+{
+    arena_t *arena = context;
+    if ( ptr == arena->last ) {     // grow or shrink in place if possible
+        size_t available = (size_t)( arena->end - arena->last );
+        size_t aligned = align_size( size );
+        if ( aligned <= available ) {
+            size_t previous = (size_t)( arena->top - arena->last );
+            arena->top = arena->last + aligned;
+            arena->used = arena->used - previous + aligned;
+            return ptr;
+        }
+    }
+    void *new_ptr = arena_alloc( context, size );
+    if ( NULL != new_ptr ) {
+        memcpy( new_ptr, ptr, ( old_size < size ) ? old_size : size );
+    }
+    return new_ptr;
+}
+
+extern arena_t *new_arena( size_t block_size )
+{
+    arena_t *arena = malloc( sizeof(arena_t) );
+    if ( NULL == arena ) return NULL;
+
+    arena->allocator.alloc = arena_alloc;
+    arena->allocator.realloc = arena_realloc;
+    arena->allocator.free = NULL;           // region mode
+    arena->allocator.context = arena;
+    arena->block_size = align_size( ( block_size ) ? block_size
+                                                   : ARENA_BLOCK_SIZE );
+    arena->size = 0;
+    arena->first = new_block( arena, arena->block_size );
+    if ( NULL == arena->first ) {
+        free( arena );
+        return NULL;
+    }
+    arena_reset( arena );
+    return arena;
+}
+
+extern const allocator_t *arena_allocator( arena_t *arena )
+{
+    if ( NULL == arena ) return NULL;
+    return &arena->allocator;
+}
+
+extern void arena_reset( arena_t *arena )
+{
+    if ( NULL == arena ) return;
+
+    use_block( arena, arena->first );
+    arena->last = NULL;
+    arena->used = 0;
+}
+
+extern size_t arena_used( const arena_t *arena )
+{
+    if ( NULL == arena ) return 0;
+    return arena->used;
+}
+
+extern size_t arena_size( const arena_t *arena )
+{
+    if ( NULL == arena ) return 0;
+    return arena->size;
+}
+
+extern void arena_free( arena_t *arena )
+{
+    if ( NULL == arena ) return;
+
+    arena_block_t *next;
+    for ( arena_block_t *block = arena->first; block != NULL; block = next ) {
+        next = block->next;
+        free( block );
+    }
+    free( arena );
+}
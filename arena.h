@@ -0,0 +1,73 @@
+
+#ifndef __ARENA_H__
+#define __ARENA_H__
+
+#include <stddef.h>
+
+#include "alloc.h"
+
+/*
+    Arena (region) allocator
+
+    An arena gives memory by bumping a pointer in large blocks, and never frees
+    anything individually: all its memory is released at once, either to be
+    reused by calling arena_reset, or to the system by calling arena_free. It
+    is intended for request-scoped data, where many containers are created
+    during a request and all dropped at the end of it.
+
+    Containers created with the arena allocator (arena_allocator) take all
+    their memory from the arena: headers, vector data, map tables and entries,
+    fifo and queue list entries. For instance:
+
+        arena_t *arena = new_arena( 0 );
+        const allocator_t *allocator = arena_allocator( arena );
+
+        for each request:
+            slice_t *slice = new_slice_with_allocator( 8, 0, allocator );
+            map_t *map = new_map_with_allocator( hash, same, 0, 0, allocator );
+            ...
+            arena_reset( arena );   // slice and map do not exist anymore
+
+    The arena allocator has no free function, so that freeing a container
+    (e.g. slice_free or map_free) does nothing but reading its header, and it
+    is not required before arena_reset. Mapped vectors are the exception:
+    their data is not allocated by the arena and they must be freed. A vector
+    growing with the last allocation in the arena is extended in place,
+    otherwise its data is copied and the previous data is lost until the
+    arena is reset.
+
+    An arena is not thread safe: it must be used by a single thread at a time,
+    and maps using it run bulk operations on a single thread.
+*/
+
+typedef struct arena arena_t;
+
+// default size of arena blocks
+#define ARENA_BLOCK_SIZE    65536
+
+// create a new arena, allocating memory in blocks of block_size bytes, or
+// ARENA_BLOCK_SIZE bytes if block_size is 0. Larger allocations get their own
+// block. It returns NULL in case of failure (no memory).
+extern arena_t *new_arena( size_t block_size );
+
+// return the allocator taking memory from the arena, to be given to the
+// new_xxx_with_allocator functions or to set_default_allocator.
+extern const allocator_t *arena_allocator( arena_t *arena );
+
+// release all memory allocated from the arena in O(1), without returning its
+// blocks to the system, so that they can be reused. All containers allocated
+// from the arena become invalid.
+extern void arena_reset( arena_t *arena );
+
+// return the number of bytes allocated from the arena since it was created or
+// reset, including alignment padding, or 0 if the argument arena is NULL.
+extern size_t arena_used( const arena_t *arena );
+
+// return the total size of the arena blocks, or 0 if the argument is NULL.
+extern size_t arena_size( const arena_t *arena );
+
+// free the arena and all its blocks. All containers allocated from the arena
+// become invalid.
+extern void arena_free( arena_t *arena );
+
+#endif /* __ARENA_H__ */
@@ -0,0 +1,303 @@
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <math.h>
+
+#include "bloom.h"
+#include "xxh64.h"
+
+#define BLOCK_BITS          512             // one 64-byte cache line
+#define BLOCK_WORDS         ( BLOCK_BITS / 64 )
+#define BLOCK_BYTES         ( BLOCK_BITS / 8 )
+#define MAX_PROBES          16
+#define MAX_BLOCKS          ( (size_t)1 << 32 )
+// number of keys whose blocks are prefetched together in batch queries
+#define BLOOM_BATCH         16
+
+#define BLOOM_MAGIC         "BLM1"
+#define BLOOM_HEADER_SIZE   16      // magic, probes (32-bit), blocks (64-bit)
+
+#if defined( __GNUC__ )
+#define PREFETCH( addr )    __builtin_prefetch( addr )
+#else
+#define PREFETCH( addr )
+#endif
+
+struct bloom {
+    uint64_t    *blocks;            // nblocks * BLOCK_WORDS, 64-byte aligned
+    void        *memory;            // allocated memory holding blocks
+    size_t      nblocks;
+    uint32_t    probes;
+};
+
+static inline size_t block_index( const bloom_t *bloom, uint64_t hash )
+{
+    return (size_t)( ( ( hash >> 32 ) * bloom->nblocks ) >> 32 );
+}
+
+// set the k bits of a key in an 8-word mask. Each probe bit position is given
+// by the top 9 bits of a 64-bit sequence seeded by the hash, advanced by one
+// multiplication per probe. Plain double hashing (h1 + i * h2) does not work
+// well within 512 bits: the first 2 positions of a key nearly determine all
+// the others, which measurably increases the false positive rate.
+static inline void make_mask( uint64_t hash, uint32_t probes,
+                              uint64_t mask[BLOCK_WORDS] )
+{
+    uint64_t h = hash;
+
+    memset( mask, 0, sizeof(uint64_t) * BLOCK_WORDS );
+    for ( uint32_t i = 0; i < probes; ++i ) {
+        h = h * 0x9e3779b97f4a7c15 + 0x632be59bd9b4e019;
+        uint32_t bit = (uint32_t)( h >> 55 );
+        mask[bit >> 6] |= (uint64_t)1 << ( bit & 63 );
+    }
+}
+
+// test all mask bits in a block at once: the loop on block words has no
+// branch, so that compilers can turn it into a few vector instructions.
+static inline bool test_mask( const uint64_t *block,
+                              const uint64_t mask[BLOCK_WORDS] )
+{
+    uint64_t missing = 0;
+    for ( int w = 0; w < BLOCK_WORDS; ++w ) {
+        missing |= mask[w] & ~block[w];
+    }
+    return 0 == missing;
+}
+
+// estimated false positive rate of a blocked filter with nblocks blocks and
+// probes bits per key, holding n keys: the number of keys in a block follows
+// a Poisson distribution of mean n / nblocks, and the probes of a key may hit
+// the same bit, so that fewer distinct bits are tested.
+static double false_positive_rate( size_t n, size_t nblocks, uint32_t probes )
+{
+    double lambda = (double)n / (double)nblocks;
+    double distinct = BLOCK_BITS * ( 1.0 - pow( 1.0 - 1.0 / BLOCK_BITS,
+                                                probes ) );
+    double limit = lambda + 10.0 * sqrt( lambda ) + 10.0;
+    double rate = 0.0;
+
+    for ( double j = 0.0; j <= limit; j += 1.0 ) {
+        double p = exp( j * log( lambda ) - lambda - lgamma( j + 1.0 ) );
+        double set = 1.0 - pow( 1.0 - 1.0 / BLOCK_BITS, j * probes );
+        rate += p * pow( set, distinct );
+    }
+    return rate;
+}
+
+static bloom_t *alloc_bloom( size_t nblocks, uint32_t probes )
+{
+    bloom_t *bloom = malloc( sizeof(bloom_t) );
+    if ( NULL == bloom ) return NULL;
+
+    bloom->memory = calloc( nblocks * BLOCK_BYTES + BLOCK_BYTES - 1, 1 );
+    if ( NULL == bloom->memory ) {
+        free( bloom );
+        return NULL;
+    }
+    uintptr_t address = (uintptr_t)bloom->memory;
+    address = ( address + BLOCK_BYTES - 1 ) & ~(uintptr_t)( BLOCK_BYTES - 1 );
+    bloom->blocks = (uint64_t *)address;
+    bloom->nblocks = nblocks;
+    bloom->probes = probes;
+    return bloom;
+}
+
+extern bloom_t *new_bloom( size_t n, double fp_rate )
+{
+    if ( ! ( fp_rate > 0.0 && fp_rate < 1.0 ) ) return NULL;
+    if ( 0 == n ) n = 1;
+
+    double ln2 = log( 2.0 );
+    double bits_per_key = -log( fp_rate ) / ( ln2 * ln2 );
+    if ( bits_per_key < 1.0 ) bits_per_key = 1.0;
+
+    double k = floor( bits_per_key * ln2 + 0.5 );
+    uint32_t probes = ( k < 1.0 ) ? 1 :
+                            ( k > MAX_PROBES ) ? MAX_PROBES : (uint32_t)k;
+
+    double blocks = ceil( (double)n * bits_per_key / BLOCK_BITS );
+    if ( blocks > (double)MAX_BLOCKS ) return NULL;
+    size_t nblocks = (size_t)blocks;
+
+    // blocked filters need a few more bits per key than standard filters
+    while ( false_positive_rate( n, nblocks, probes ) > fp_rate ) {
+        nblocks += nblocks / 32 + 1;
+        if ( nblocks > MAX_BLOCKS ) return NULL;
+    }
+    return alloc_bloom( nblocks, probes );
+}
+
+extern int bloom_free( bloom_t *bloom )
+{
+    if ( NULL == bloom ) return -1;
+    free( bloom->memory );
+    free( bloom );
+    return 0;
+}
+
+extern void bloom_insert_hash( bloom_t *bloom, uint64_t hash )
+{
+    if ( NULL == bloom ) return;
+
+    uint64_t mask[BLOCK_WORDS];
+    make_mask( hash, bloom->probes, mask );
+
+    uint64_t *block = &bloom->blocks[ block_index( bloom, hash ) * BLOCK_WORDS ];
+    for ( int w = 0; w < BLOCK_WORDS; ++w ) {
+        block[w] |= mask[w];
+    }
+}
+
+extern void bloom_insert( bloom_t *bloom, uint8_t *data, size_t len )
+{
+    if ( NULL == bloom || NULL == data ) return;
+    bloom_insert_hash( bloom, xxh64( data, len ) );
+}
+
+extern bool bloom_query_hash( const bloom_t *bloom, uint64_t hash )
+{
+    if ( NULL == bloom ) return false;
+
+    uint64_t mask[BLOCK_WORDS];
+    make_mask( hash, bloom->probes, mask );
+    return test_mask( &bloom->blocks[ block_index( bloom, hash ) * BLOCK_WORDS ],
+                      mask );
+}
+
+extern bool bloom_query( const bloom_t *bloom, uint8_t *data, size_t len )
+{
+    if ( NULL == bloom || NULL == data ) return false;
+    return bloom_query_hash( bloom, xxh64( data, len ) );
+}
+
+// query up to BLOOM_BATCH hashes: all blocks are prefetched before testing
+// the first one, so that their cache misses overlap.
+static size_t query_batch( const bloom_t *bloom, const uint64_t hashes[],
+                           size_t n, bool results[] )
+{
+    const uint64_t *blocks[BLOOM_BATCH];
+    uint64_t mask[BLOCK_WORDS];
+    size_t found = 0;
+
+    for ( size_t i = 0; i < n; ++i ) {
+        blocks[i] = &bloom->blocks[ block_index( bloom, hashes[i] ) *
+                                                            BLOCK_WORDS ];
+        PREFETCH( blocks[i] );
+    }
+    for ( size_t i = 0; i < n; ++i ) {
+        make_mask( hashes[i], bloom->probes, mask );
+        results[i] = test_mask( blocks[i], mask );
+        found += results[i];
+    }
+    return found;
+}
+
+extern size_t bloom_query_hash_batch( const bloom_t *bloom,
+                                      const uint64_t hashes[], size_t n,
+                                      bool results[] )
+{
+    if ( NULL == bloom || NULL == hashes || NULL == results ) return 0;
+
+    size_t found = 0;
+    for ( size_t i = 0; i < n; i += BLOOM_BATCH ) {
+        size_t count = ( n - i < BLOOM_BATCH ) ? n - i : BLOOM_BATCH;
+        found += query_batch( bloom, &hashes[i], count, &results[i] );
+    }
+    return found;
+}
+
+extern size_t bloom_query_batch( const bloom_t *bloom, uint8_t *keys[],
+                                 size_t lens[], size_t n, bool results[] )
+{
+    if ( NULL == bloom || NULL == keys || NULL == lens || NULL == results )
+        return 0;
+
+    uint64_t hashes[BLOOM_BATCH];
+    size_t found = 0;
+    for ( size_t i = 0; i < n; i += BLOOM_BATCH ) {
+        size_t count = ( n - i < BLOOM_BATCH ) ? n - i : BLOOM_BATCH;
+        for ( size_t j = 0; j < count; ++j ) {
+            hashes[j] = xxh64( keys[i + j], lens[i + j] );
+        }
+        found += query_batch( bloom, hashes, count, &results[i] );
+    }
+    return found;
+}
+
+extern uint32_t bloom_probes( const bloom_t *bloom )
+{
+    if ( NULL == bloom ) return 0;
+    return bloom->probes;
+}
+
+extern size_t bloom_bytes( const bloom_t *bloom )
+{
+    if ( NULL == bloom ) return 0;
+    return bloom->nblocks * BLOCK_BYTES;
+}
+
+static void write_le( uint8_t *dst, uint64_t value, int nbytes )
+{
+    for ( int i = 0; i < nbytes; ++i ) {
+        dst[i] = (uint8_t)( value >> ( 8 * i ) );
+    }
+}
+
+static uint64_t read_le( const uint8_t *src, int nbytes )
+{
+    uint64_t value = 0;
+    for ( int i = 0; i < nbytes; ++i ) {
+        value |= (uint64_t)src[i] << ( 8 * i );
+    }
+    return value;
+}
+
+extern slice_t *bloom_to_slice( const bloom_t *bloom )
+{
+    if ( NULL == bloom ) return NULL;
+
+    size_t nwords = bloom->nblocks * BLOCK_WORDS;
+    size_t size = BLOOM_HEADER_SIZE + nwords * 8;
+    slice_t *slice = new_slice( 1, size );
+    if ( NULL == slice ) return NULL;
+
+    slice_update_len( slice, size );
+    uint8_t *data = slice_data_n_len( slice, NULL );
+    memcpy( data, BLOOM_MAGIC, 4 );
+    write_le( data + 4, bloom->probes, 4 );
+    write_le( data + 8, bloom->nblocks, 8 );
+
+    data += BLOOM_HEADER_SIZE;
+    for ( size_t i = 0; i < nwords; ++i ) {
+        write_le( data + i * 8, bloom->blocks[i], 8 );
+    }
+    return slice;
+}
+
+extern bloom_t *new_bloom_from_slice( const slice_t *slice )
+{
+    size_t size;
+    const uint8_t *data = slice_data_n_len( slice, &size );
+
+    if ( NULL == data || 1 != slice_item_size( slice ) ||
+         size < BLOOM_HEADER_SIZE || 0 != memcmp( data, BLOOM_MAGIC, 4 ) )
+        return NULL;
+
+    uint64_t probes = read_le( data + 4, 4 );
+    uint64_t nblocks = read_le( data + 8, 8 );
+    if ( 0 == probes || probes > MAX_PROBES || 0 == nblocks ||
+         nblocks > MAX_BLOCKS ||
+         size - BLOOM_HEADER_SIZE != nblocks * BLOCK_BYTES )
+        return NULL;
+
+    bloom_t *bloom = alloc_bloom( (size_t)nblocks, (uint32_t)probes );
+    if ( NULL == bloom ) return NULL;
+
+    data += BLOOM_HEADER_SIZE;
+    for ( size_t i = 0; i < nblocks * BLOCK_WORDS; ++i ) {
+        bloom->blocks[i] = read_le( data + i * 8, 8 );
+    }
+    return bloom;
+}
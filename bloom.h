@@ -0,0 +1,86 @@
+
+#ifndef __BLOOM_H__
+#define __BLOOM_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "slice.h"
+
+/*
+    Blocked Bloom filter
+
+    A Bloom filter answers "definitely not present" or "possibly present" for a
+    key, using a few bits per key instead of storing the keys themselves: with
+    a 1% false positive rate it takes about 10 bits (1.2 bytes) per key, where
+    a map_t takes at least 32 bytes per key.
+
+    In a standard Bloom filter, the k bits of a key are spread over the whole
+    bit array, so that each query can cost k cache misses. In this blocked
+    filter, all k bits of a key are in a single 64-byte block (one cache line),
+    so that a query costs at most one cache miss and the k bit tests are done
+    at once by comparing the block words with a mask. For the same number of
+    bits per key, the false positive rate is slightly higher than in a standard
+    filter, which new_bloom compensates by allocating a few more bits.
+
+    Keys are hashed once with xxh64 (see xxh64.h), which gives the same values
+    on all hosts, so that a filter can be serialized and loaded elsewhere. The
+    block is selected by the upper 32 bits of the hash, and the k bit positions
+    within the block are derived from the same hash, without hashing the key
+    again. The _hash functions take a 64-bit hash value that was already
+    calculated by the caller, which must then use the same hash function for
+    all insertions and queries on that filter.
+
+    Keys are never stored and cannot be removed.
+
+    Filter sizing uses the math library: the program must be linked with -lm.
+*/
+
+typedef struct bloom bloom_t;
+
+// allocate a new empty filter, sized for n keys with a false positive rate
+// fp_rate (between 0 and 1 excluded, e.g. 0.01 for 1%). It returns NULL in
+// case of wrong arguments or failure (no memory).
+extern bloom_t *new_bloom( size_t n, double fp_rate );
+
+// free an existing filter.
+extern int bloom_free( bloom_t *bloom );
+
+// insert a key given by its data and length, or by its 64-bit hash value.
+extern void bloom_insert( bloom_t *bloom, uint8_t *data, size_t len );
+extern void bloom_insert_hash( bloom_t *bloom, uint64_t hash );
+
+// query a key given by its data and length, or by its 64-bit hash value. It
+// returns false if the key was never inserted, or true if it may have been
+// inserted.
+extern bool bloom_query( const bloom_t *bloom, uint8_t *data, size_t len );
+extern bool bloom_query_hash( const bloom_t *bloom, uint64_t hash );
+
+// query n keys given by the arrays keys and lens, or by the array of hash
+// values hashes, and store the individual results in the results array. It
+// is faster than querying keys one at a time on large filters, since blocks
+// are prefetched ahead of the tests. It returns the number of keys that may
+// have been inserted (number of true results).
+extern size_t bloom_query_batch( const bloom_t *bloom, uint8_t *keys[],
+                                 size_t lens[], size_t n, bool results[] );
+extern size_t bloom_query_hash_batch( const bloom_t *bloom,
+                                      const uint64_t hashes[], size_t n,
+                                      bool results[] );
+
+// return the number of probes (bits set) per key
+extern uint32_t bloom_probes( const bloom_t *bloom );
+
+// return the memory size of the filter bit array in bytes
+extern size_t bloom_bytes( const bloom_t *bloom );
+
+// return a new slice of bytes (item_size 1) holding the serialized filter,
+// which is independent of the host byte order, or NULL in case of failure (no
+// memory). After use the returned slice must be freed by calling slice_free.
+extern slice_t *bloom_to_slice( const bloom_t *bloom );
+
+// allocate a new filter from a slice of bytes previously returned by
+// bloom_to_slice. It returns NULL if the slice does not hold a valid filter
+// or in case of failure (no memory).
+extern bloom_t *new_bloom_from_slice( const slice_t *slice );
+
+#endif /* __BLOOM_H__ */
@@ -5,6 +5,7 @@
 #include "slice.h"
 #include "_slice.h"
 #include "fifo.h"
+#include "slab.h"
 
 typedef struct _slltentry {
     struct _slltentry * next;
@@ -18,13 +19,42 @@ struct _fifo {
 
     node_free_fct   node_free;  // free function
     int             start;      // index inside vector at head
+    const allocator_t *allocator;   // for the fifo and its entries
+    slab_t          *entries;   // entry cache with the malloc allocator
 };
 
+static inline slltentry *alloc_entry( fifo_t *q )
+{
+    if ( q->entries ) return slab_alloc( q->entries );
+    return allocator_alloc( q->allocator, sizeof( slltentry ) );
+}
+
+static inline void free_entry( fifo_t *q, slltentry *entry )
+{
+    if ( q->entries ) {
+        slab_release( q->entries, entry );
+    } else {
+        allocator_free( q->allocator, entry, sizeof( slltentry ) );
+    }
+}
+
 extern fifo_t *new_fifo( node_free_fct node_free )
 {
-    fifo_t *fifo = malloc( sizeof( fifo_t ) );
+    return new_fifo_with_allocator( node_free, NULL );
+}
+
+extern fifo_t *new_fifo_with_allocator( node_free_fct node_free,
+                                        const allocator_t *allocator )
+{
+    if ( NULL == allocator ) allocator = default_allocator( );
+    if ( NULL == allocator->alloc ) return NULL;
+
+    fifo_t *fifo = allocator_alloc( allocator, sizeof( fifo_t ) );
 
     if ( NULL != fifo ) {
+        fifo->allocator = allocator;
+        fifo->entries = ( allocator == malloc_allocator( ) ) ?
+                            shared_slab( sizeof( slltentry ) ) : NULL;
         fifo->head = fifo->tail = NULL;
         if ( node_free ) {
             fifo->node_free = node_free;
@@ -67,18 +97,18 @@ extern void fifo_free( fifo_t * q, bool free_nodes )
         next = entry->next;
         entry->next = NULL;
         entry->data = NULL;
-        free( entry );
+        free_entry( q, entry );
         q->start = 0;
     }
     q->head = q->tail = NULL;
-    free( q );
+    allocator_free( q->allocator, q, sizeof( fifo_t ) );
 }
 
 extern int fifo_insert( fifo_t * q, void *data )
 {
     if ( NULL == q || NULL == data ) return -1;
 
-    slltentry *entry = malloc( sizeof( slltentry ) );
+    slltentry *entry = alloc_entry( q );
     if ( NULL == entry ) return -1;
 
     entry->next = NULL;
@@ -100,7 +130,7 @@ extern int fifo_insert_slice( fifo_t *q, slice_t *slice )
     if ( NULL == q || NULL == slice ||
         sizeof(void *) != _slice_item_size( slice ) ) return -1;
 
-    slltentry *entry = malloc( sizeof( slltentry ) );
+    slltentry *entry = alloc_entry( q );
     if ( NULL == entry ) return -1;
 
     entry->next = NULL;
@@ -127,7 +157,7 @@ static inline void sll_next( fifo_t *q, slltentry *head )
         q->tail = NULL;
     }
     q->start = 0;
-    free( head );
+    free_entry( q, head );
 }
 
 extern void *fifo_extract( fifo_t * q )
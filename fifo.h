@@ -31,6 +31,12 @@ typedef struct _fifo fifo_t;
 // is NULL, nodes are deleted by calling free.
 extern fifo_t *new_fifo( node_free_fct node_free );
 
+// same as new_fifo, but the fifo and its list entries are allocated with the
+// given allocator (see alloc.h), or with the default allocator if it is NULL.
+// Nodes are not allocated by the fifo and are still freed by node_free.
+extern fifo_t *new_fifo_with_allocator( node_free_fct node_free,
+                                        const allocator_t *allocator );
+
 // delete an existing fifo queue and its non-extracted nodes depending on the
 // argument free_nodes.
 extern void fifo_free( fifo_t * q , bool free_nodes );
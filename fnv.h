@@ -59,3 +59,14 @@ uint64_t fnv1a_64_append( uint64_t hash, uint8_t *data, size_t len );
 
 // calculate the 64-bit FNV hash on a buffer
 uint64_t fnv1a_64( uint8_t *data, size_t len );
+
+// calculate the 64-bit FNV hash of n keys, each given by a pointer in keys and
+// its length at the same index in lens, and store the hash values in out. The
+// results are the same as calling fnv1a_64 on each key, but keys are hashed
+// in interleaved lanes so that the multiplications of different keys overlap.
+void fnv1a_64_batch( uint8_t *keys[], size_t lens[], size_t n,
+                     uint64_t out[] );
+
+// same as fnv1a_64_batch for n keys of the same length len.
+void fnv1a_64_batch_fixed( uint8_t *keys[], size_t len, size_t n,
+                           uint64_t out[] );
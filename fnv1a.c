@@ -2,6 +2,26 @@
 
 #include "fnv.h"
 
+// multiplying is faster than the equivalent shift and add sequence on most
+// current CPUs. Build with -DFAST_MUL=0 to use shifts and adds instead.
+#ifndef FAST_MUL
+#define FAST_MUL 1
+#endif
+
+#define FNV_OFFSET_BASIS    0xcbf29ce484222325  // 14695981039346656037
+#define FNV_BATCH_LANES     4
+
+static inline uint64_t fnv1a_64_step( uint64_t hash, uint8_t byte )
+{
+    hash ^= (uint64_t)byte;
+#if FAST_MUL
+    hash *= 0x00000100000001B3;     // 1099511628211;
+#else
+    hash += (hash << 1) + (hash << 4) + (hash << 5) +
+            (hash << 7) + (hash << 8) + (hash << 40);
+#endif
+    return hash;
+}
 
 static inline uint64_t _fnv1a_64_append( uint64_t hash,
                                          uint8_t *data, size_t len )
@@ -9,13 +29,7 @@ static inline uint64_t _fnv1a_64_append( uint64_t hash,
     uint8_t *end = data + len;
 
     while ( data < end ) {
-        hash ^= (uint64_t)(*data++);
-#if FAST_MUL
-        hash *= 0x00000100000001B3;     // 1099511628211;
-#else
-        hash += (hash << 1) + (hash << 4) + (hash << 5) +
-                (hash << 7) + (hash << 8) + (hash << 40);
-#endif
+        hash = fnv1a_64_step( hash, *data++ );
     }
     return hash;
 }
@@ -27,6 +41,57 @@ uint64_t fnv1a_64_append( uint64_t hash, uint8_t *data, size_t len )
 
 uint64_t fnv1a_64( uint8_t *data, size_t len )
 {
-    uint64_t hash = 0xcbf29ce484222325; // 14695981039346656037
-    return _fnv1a_64_append( hash, data, len );
+    return _fnv1a_64_append( FNV_OFFSET_BASIS, data, len );
+}
+
+// hash the first len bytes of FNV_BATCH_LANES keys in lockstep
+static inline void fnv1a_64_lanes( uint8_t *keys[], size_t len,
+                                   uint64_t hashes[] )
+{
+    uint64_t h0 = FNV_OFFSET_BASIS, h1 = FNV_OFFSET_BASIS;
+    uint64_t h2 = FNV_OFFSET_BASIS, h3 = FNV_OFFSET_BASIS;
+    uint8_t *k0 = keys[0], *k1 = keys[1], *k2 = keys[2], *k3 = keys[3];
+
+    for ( size_t i = 0; i < len; ++i ) {
+        h0 = fnv1a_64_step( h0, k0[i] );
+        h1 = fnv1a_64_step( h1, k1[i] );
+        h2 = fnv1a_64_step( h2, k2[i] );
+        h3 = fnv1a_64_step( h3, k3[i] );
+    }
+    hashes[0] = h0;
+    hashes[1] = h1;
+    hashes[2] = h2;
+    hashes[3] = h3;
+}
+
+void fnv1a_64_batch( uint8_t *keys[], size_t lens[], size_t n,
+                     uint64_t out[] )
+{
+    size_t i = 0;
+    for ( ; i + FNV_BATCH_LANES <= n; i += FNV_BATCH_LANES ) {
+        size_t common = lens[i];            // lockstep on the shortest key
+        for ( size_t l = 1; l < FNV_BATCH_LANES; ++l ) {
+            if ( lens[i+l] < common ) common = lens[i+l];
+        }
+        fnv1a_64_lanes( &keys[i], common, &out[i] );
+        for ( size_t l = 0; l < FNV_BATCH_LANES; ++l ) {
+            out[i+l] = _fnv1a_64_append( out[i+l], keys[i+l] + common,
+                                         lens[i+l] - common );
+        }
+    }
+    for ( ; i < n; ++i ) {
+        out[i] = _fnv1a_64_append( FNV_OFFSET_BASIS, keys[i], lens[i] );
+    }
+}
+
+void fnv1a_64_batch_fixed( uint8_t *keys[], size_t len, size_t n,
+                           uint64_t out[] )
+{
+    size_t i = 0;
+    for ( ; i + FNV_BATCH_LANES <= n; i += FNV_BATCH_LANES ) {
+        fnv1a_64_lanes( &keys[i], len, &out[i] );
+    }
+    for ( ; i < n; ++i ) {
+        out[i] = _fnv1a_64_append( FNV_OFFSET_BASIS, keys[i], len );
+    }
 }
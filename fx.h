@@ -0,0 +1,34 @@
+
+#include <stdlib.h>
+#include <stdint.h>
+
+/*
+    FxHash implementation
+
+    This hashing algorithm was extracted from the Rustc compiler. This is the
+    same hashing algorithm used for some internal operations in Firefox.
+
+    The strength of this algorithm is in hashing 8 bytes at a time on any
+    platform, where the FNV algorithm works on one byte at a time: each step
+    rotates the current hash value, xors the next word and multiplies the
+    result by a constant. Remaining bytes are hashed as a 4-byte, a 2-byte and
+    a 1-byte word, as needed. Words are read in native byte order, so that the
+    hash value of the same data differs on little-endian and big-endian hosts.
+
+    Since a multiplication only propagates bits toward the most significant
+    bits, a difference limited to the top bits of a word hardly affects the
+    final hash value: keys differing only there (e.g. in the last character of
+    an 8-byte word of text) collide much more often than expected. Prefer
+    xxh64 (see xxh64.h) for such keys.
+
+    This hashing algorithm should not be used for cryptographic purpose, or in
+    scenarios where DOS attacks are a concern.
+*/
+
+// append to an already calculated hash value. The result is the same as the
+// hash of all data at once as long as previous data lengths were multiple of
+// 8 bytes.
+uint64_t fxhash_64_append( uint64_t hash, uint8_t *data, size_t len );
+
+// calculate the 64-bit FxHash on a buffer
+uint64_t fxhash_64( uint8_t *data, size_t len );
@@ -0,0 +1,199 @@
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "slice.h"
+#include "_slice.h"
+#include "group.h"
+#include "partition.h"
+#include "_partition.h"
+#include "parallel.h"
+
+// target number of rows per partition: with at most twice as many slots as
+// rows, the partition table and its groups fit in a typical L2 cache.
+#define GROUP_PARTITION_ROWS    2048
+
+typedef struct {
+    const slice_t   *slice;
+    partition_t     *partition;
+    same_fct        same;
+    agg_init_fct    agg_init;
+    agg_update_fct  agg_update;
+    slice_t         **groups;       // per task groups
+    bool            *failed;        // per task (no memory)
+} grouping_t;
+
+static inline bool same_key( const grouping_t *g,
+                             const void *key1, const void *key2 )
+{
+    return ( g->same ) ? g->same( key1, key2 ) : key1 == key2;
+}
+
+// aggregate one partition with an open addressing table of slots, each slot
+// being 0 if unused or the group index + 1 in the task groups slice.
+static bool aggregate_partition( grouping_t *g, size_t index, slice_t *groups,
+                                 uint32_t *slots, uint64_t *hashes )
+{
+    size_t n;
+    const partition_row_t *rows = _partition_rows( g->partition, index, &n );
+    if ( 0 == n ) return true;
+
+    uint32_t table_bits = 1;
+    while ( ( (size_t)1 << table_bits ) < 2 * n ) ++table_bits;
+    size_t mask = ( (size_t)1 << table_bits ) - 1;
+    memset( slots, 0, sizeof(uint32_t) * (mask + 1) );
+
+    uint32_t bits = g->partition->bits;
+    size_t base = _slice_len( groups );
+    for ( size_t i = 0; i < n; ++i ) {
+        const partition_row_t *row = &rows[i];
+        const void *item = _slice_item_at( g->slice, row->row );
+
+        size_t slot = _partition_slot( row->hash, bits, table_bits );
+        while ( true ) {
+            uint32_t local = slots[slot];
+            if ( 0 == local ) {         // new group
+                group_t group = { row->key, g->agg_init( row->key, item ) };
+                if ( -1 == _slice_append_item( groups, &group ) ) {
+                    return false;
+                }
+                hashes[ _slice_len( groups ) - base - 1 ] = row->hash;
+                slots[slot] = (uint32_t)(_slice_len( groups ) - base);
+                break;
+            }
+            if ( hashes[local-1] == row->hash ) {
+                group_t *group = _slice_item_at( groups, base + local - 1 );
+                if ( same_key( g, group->key, row->key ) ) {
+                    group->agg = g->agg_update( group->agg, item );
+                    break;
+                }
+            }
+            slot = ( slot + 1 ) & mask; // linear probing
+        }
+    }
+    return true;
+}
+
+static size_t max_partition_len( const partition_t *partition )
+{
+    size_t max = 0;
+    for ( size_t i = 0; i < _partition_count( partition ); ++i ) {
+        size_t n;
+        _partition_rows( partition, i, &n );
+        if ( n > max ) max = n;
+    }
+    return max;
+}
+
+static void aggregate( size_t task, size_t ntasks, void *context )
+{
+    grouping_t *g = context;
+    size_t max = max_partition_len( g->partition );
+
+    size_t table = 2;
+    while ( table < 2 * max ) table *= 2;
+    uint32_t *slots = malloc( sizeof(uint32_t) * table );
+    uint64_t *hashes = malloc( sizeof(uint64_t) * ( max ? max : 1 ) );
+    // tasks run on multiple threads, and only malloc is thread safe: the
+    // result is copied into a slice from the default allocator at the end.
+    slice_t *groups = new_slice_with_allocator( sizeof(group_t), 0,
+                                                malloc_allocator() );
+    g->groups[task] = groups;
+
+    if ( NULL == slots || NULL == hashes || NULL == groups ) {
+        g->failed[task] = true;
+    } else {    // interleave partitions to spread large ones among tasks
+        size_t count = _partition_count( g->partition );
+        for ( size_t i = task; i < count; i += ntasks ) {
+            if ( ! aggregate_partition( g, i, groups, slots, hashes ) ) {
+                g->failed[task] = true;
+                break;
+            }
+        }
+    }
+    free( slots );
+    free( hashes );
+}
+
+// release the aggregates of all task groups after a failure
+static void free_aggregates( const grouping_t *g, size_t ntasks,
+                             agg_free_fct agg_free )
+{
+    for ( size_t t = 0; NULL != agg_free && t < ntasks; ++t ) {
+        if ( NULL == g->groups[t] ) continue;
+
+        size_t len;
+        group_t *groups = (group_t *)_slice_data_n_len( g->groups[t], &len );
+        for ( size_t i = 0; i < len; ++i ) {
+            agg_free( groups[i].agg );
+        }
+    }
+}
+
+extern slice_t *slice_group_by( const slice_t *slice, row_key_fct key_fn,
+                                hash_fct hash, same_fct same,
+                                agg_init_fct agg_init,
+                                agg_update_fct agg_update,
+                                agg_free_fct agg_free, size_t nthreads )
+{
+    if ( NULL == slice || NULL == key_fn || ( NULL != hash && NULL == same ) ||
+         NULL == agg_init || NULL == agg_update ) {
+        return NULL;
+    }
+
+    size_t n = _slice_len( slice );
+    uint32_t bits = partition_bits( n, GROUP_PARTITION_ROWS );
+    partition_t *partition = new_partition( slice, key_fn, hash,
+                                            bits, nthreads );
+    if ( NULL == partition ) return NULL;
+
+    size_t ntasks = _partition_count( partition );
+    if ( ntasks > nthreads ) ntasks = nthreads;
+    if ( 0 == ntasks ) ntasks = 1;
+
+    grouping_t g = { .slice = slice, .partition = partition, .same = same,
+                     .agg_init = agg_init, .agg_update = agg_update };
+    g.groups = calloc( ntasks, sizeof(slice_t *) );
+    g.failed = calloc( ntasks, sizeof(bool) );
+    if ( NULL == g.groups || NULL == g.failed ) {
+        free( g.groups );
+        free( g.failed );
+        partition_free( partition );
+        return NULL;
+    }
+    parallel_run( aggregate, ntasks, &g );
+    partition_free( partition );
+
+    bool failed = false;
+    for ( size_t t = 0; t < ntasks; ++t ) {
+        if ( g.failed[t] ) failed = true;
+    }
+    slice_t *result = NULL;
+    if ( ! failed ) {               // concatenate all task groups
+        size_t total = 0;
+        for ( size_t t = 0; t < ntasks; ++t ) {
+            total += _slice_len( g.groups[t] );
+        }
+        result = new_slice( sizeof(group_t), total );
+        if ( NULL != result && total ) {
+            uint8_t *data = _slice_data_n_len( result, NULL );
+            for ( size_t t = 0; t < ntasks; ++t ) {
+                size_t len;
+                void *groups = _slice_data_n_len( g.groups[t], &len );
+                memcpy( data, groups, len * sizeof(group_t) );
+                data += len * sizeof(group_t);
+            }
+            _slice_update_len( result, total );
+        }
+    }
+    if ( NULL == result ) {
+        free_aggregates( &g, ntasks, agg_free );
+    }
+    for ( size_t t = 0; t < ntasks; ++t ) {
+        slice_free( g.groups[t] );
+    }
+    free( g.groups );
+    free( g.failed );
+    return result;
+}
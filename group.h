@@ -0,0 +1,61 @@
+
+#ifndef __GROUP_H__
+#define __GROUP_H__
+
+#include <stddef.h>
+
+#include "slice.h"
+#include "map.h"
+#include "partition.h"
+
+/*
+    Hash based group-by aggregation over the items (rows) of a slice.
+
+    Each row is given a key by a user function (see partition.h), rows with
+    the same key form a group, and each group is given an aggregate value,
+    created by the agg_init function for the first row in the group and then
+    updated by the agg_update function for each following row in the group.
+
+    Like data in a map, an aggregate is a void pointer that may hold any value
+    fitting in a pointer (e.g. a counter) or point to an object in memory.
+
+    Rows are first radix-partitioned by key hash, so that each partition is
+    aggregated with a hash table small enough to stay in cache. Partitions are
+    independent, and can be aggregated in parallel by multiple threads.
+*/
+
+// a group, as returned in the slice_group_by result
+typedef struct {
+    const void  *key;           // key of the first row in group
+    void        *agg;           // aggregate value
+} group_t;
+
+// return the initial aggregate value for the group starting with row, with
+// the given key.
+typedef void *(*agg_init_fct)( const void *key, const void *row );
+
+// return the updated aggregate value after adding row to the group.
+typedef void *(*agg_update_fct)( void *agg, const void *row );
+
+// release an aggregate value, e.g. free the object it points to.
+typedef void (*agg_free_fct)( void *agg );
+
+// group all rows in slice by key and return a new slice of group_t items, one
+// per distinct key, in no particular order. If hash is NULL, keys are compared
+// as pointers (see map.h), otherwise same must be given as well. The groups
+// are aggregated by nthreads threads in parallel, with the restriction that
+// all rows in the same group are always processed by the same thread. The
+// key, hash, same, agg_init and agg_update functions must be thread safe.
+// Working memory is allocated by malloc, and the returned slice by the
+// default allocator from the calling thread only (see alloc.h). It returns
+// NULL in case of failure (no memory or bad arguments), after calling
+// agg_free, if not NULL, on all aggregates already created. Otherwise, the
+// returned slice must be freed by calling slice_free, after releasing the
+// aggregates if needed (agg_free is not called).
+extern slice_t *slice_group_by( const slice_t *slice, row_key_fct key_fn,
+                                hash_fct hash, same_fct same,
+                                agg_init_fct agg_init,
+                                agg_update_fct agg_update,
+                                agg_free_fct agg_free, size_t nthreads );
+
+#endif /* __GROUP_H__ */
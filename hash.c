@@ -0,0 +1,206 @@
+
+#include <string.h>
+
+#include "hash.h"
+#include "fnv.h"
+#include "xxh64.h"
+
+#if defined( __GNUC__ ) && ( defined( __x86_64__ ) || defined( __i386__ ) )
+#define HAS_CRC32C_PATH 1
+#else
+#define HAS_CRC32C_PATH 0
+#endif
+
+typedef uint64_t (*hash_impl_fct)( uint8_t *data, size_t len );
+
+static const char *path_names[] = { "fnv1a", "multiply", "crc32c" };
+
+// final mixer from MurmurHash3, so that all input bits affect all hash bits
+static inline uint64_t fmix64( uint64_t hash )
+{
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccd;
+    hash ^= hash >> 33;
+    hash *= 0xc4ceb9fe1a85ec53;
+    hash ^= hash >> 33;
+    return hash;
+}
+
+#if HAS_CRC32C_PATH
+
+// above this length the CRC32C path is slower than xxh64, which is used
+// instead (see hash_bench throughput)
+#define CRC32C_MAX_LEN          64
+#define CRC32C_SEED_0           0x9e3779b9
+#define CRC32C_SEED_1           0x85ebca6b
+
+#define CRC32C_TARGET   __attribute__(( target( "sse4.2" ) ))
+
+static inline uint64_t read64( const uint8_t *data )
+{
+    uint64_t word;
+    memcpy( &word, data, 8 );
+    return word;
+}
+
+CRC32C_TARGET
+static inline uint64_t crc_word( uint64_t crc, uint64_t word )
+{
+    return __builtin_ia32_crc32di( crc, word );
+}
+
+// remaining 1 to 7 bytes, read as a single word with constant size reads
+static inline uint64_t tail_word( const uint8_t *data, size_t len )
+{
+    uint64_t word = 0;
+    int shift = 0;
+
+    if ( len & 4 ) {
+        uint32_t part;
+        memcpy( &part, data, 4 );
+        word = part;
+        shift = 32;
+        data += 4;
+    }
+    if ( len & 2 ) {
+        uint16_t part;
+        memcpy( &part, data, 2 );
+        word |= (uint64_t)part << shift;
+        shift += 16;
+        data += 2;
+    }
+    if ( len & 1 ) {
+        word |= (uint64_t)(*data) << shift;
+    }
+    return word;
+}
+
+// CRC32C gives 32 bits per stream, and is linear over GF(2): a hash made of
+// CRC streams only has many colliding keys (any difference in the kernel of
+// the linear function), whatever the final mixer. A pair of streams thus
+// takes each word and the word multiplied by an odd constant, which is not a
+// linear function of the word. The 64-bit state is a linear function of the
+// previous state xor a nonlinear function of the word, so that differences
+// between words do not cancel out, and the multiply is not on the state
+// dependency chain, which only has the CRC latency.
+#define CRC32C_WORD_MULTIPLIER      0x9e3779b97f4a7c15
+
+CRC32C_TARGET
+static inline uint64_t crc_pair( uint64_t state, uint64_t word )
+{
+    uint64_t c0 = crc_word( state >> 32, word );
+    uint64_t c1 = crc_word( state & 0xffffffff,
+                            word * CRC32C_WORD_MULTIPLIER );
+    return ( c0 << 32 ) | c1;
+}
+
+CRC32C_TARGET
+static uint64_t crc32c_short( const uint8_t *data, size_t len )
+{
+    uint64_t s = ( (uint64_t)CRC32C_SEED_0 << 32 ) | CRC32C_SEED_1;
+    size_t n = len;
+
+    for ( ; n >= 8; n -= 8, data += 8 ) {
+        s = crc_pair( s, read64( data ) );
+    }
+    if ( n ) {
+        s = crc_pair( s, tail_word( data, n ) );
+    }
+    return fmix64( s ^ ( (uint64_t)len * 0x9e3779b97f4a7c15 ) );
+}
+
+static uint64_t crc32c_hash( uint8_t *data, size_t len )
+{
+    if ( len > CRC32C_MAX_LEN ) {
+        return xxh64( data, len );
+    }
+    return crc32c_short( data, len );
+}
+
+static bool crc32c_supported( void )
+{
+    __builtin_cpu_init();
+    return __builtin_cpu_supports( "sse4.2" );
+}
+
+#else /* ! HAS_CRC32C_PATH */
+
+static bool crc32c_supported( void )
+{
+    return false;
+}
+
+#endif /* HAS_CRC32C_PATH */
+
+static hash_impl_fct get_impl( hash_path_t path )
+{
+    switch ( path ) {
+    case HASH_PATH_FNV1A:       return fnv1a_64;
+    case HASH_PATH_MULTIPLY:    return xxh64;
+#if HAS_CRC32C_PATH
+    case HASH_PATH_CRC32C:      return crc32c_hash;
+#else
+    case HASH_PATH_CRC32C:      break;
+#endif
+    }
+    return NULL;
+}
+
+static uint64_t resolve( uint8_t *data, size_t len );
+
+static hash_impl_fct hash_impl = resolve;
+static hash_path_t hash_path = HASH_PATH_MULTIPLY;
+
+static void select_path( void )
+{
+    hash_path = ( crc32c_supported() ) ? HASH_PATH_CRC32C : HASH_PATH_MULTIPLY;
+    hash_impl = get_impl( hash_path );
+}
+
+// first call, in case the constructor was not run: concurrent calls may
+// select the path more than once, but always with the same result.
+static uint64_t resolve( uint8_t *data, size_t len )
+{
+    select_path();
+    return hash_impl( data, len );
+}
+
+#if defined( __GNUC__ )
+__attribute__(( constructor ))
+static void init_path( void )
+{
+    if ( resolve == hash_impl ) {
+        select_path();
+    }
+}
+#endif
+
+extern uint64_t hash_64( uint8_t *data, size_t len )
+{
+    return hash_impl( data, len );
+}
+
+extern hash_path_t hash_64_path( void )
+{
+    if ( resolve == hash_impl ) {
+        select_path();
+    }
+    return hash_path;
+}
+
+extern const char *hash_64_path_name( void )
+{
+    return path_names[ hash_64_path() ];
+}
+
+extern bool hash_64_select( hash_path_t path )
+{
+    if ( HASH_PATH_CRC32C == path && ! crc32c_supported() ) return false;
+
+    hash_impl_fct impl = get_impl( path );
+    if ( NULL == impl ) return false;
+
+    hash_path = path;
+    hash_impl = impl;
+    return true;
+}
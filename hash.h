@@ -0,0 +1,54 @@
+
+#ifndef __HASH_H__
+#define __HASH_H__
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+/*
+    Hash function with runtime CPU dispatch.
+
+    hash_64 selects the fastest available implementation the first time it is
+    used (or at program startup with gcc or clang), according to the features
+    of the CPU it is running on:
+
+    - crc32c: on x86 CPUs with SSE4.2, for keys up to 64 bytes, using the
+      CRC32C instruction on 8-byte words and on the words multiplied by a
+      constant, since CRC alone is linear. It is as fast as xxh64 on keys up
+      to 16 bytes and faster on 32 to 64 bytes (see hash_bench throughput).
+      Longer keys are hashed with xxh64, which is faster on them.
+    - multiply: a portable multiply hash (xxh64, see xxh64.h), which consumes
+      8-byte words and long inputs in 4 independent lanes, used when the
+      CRC32C instruction is not available.
+    - fnv1a: the byte-at-a-time FNV-1a hash (fnv1a_64, see fnv.h), which is
+      never selected automatically but can be forced.
+
+    The hash value depends on the selected path, so that hash values must not
+    be stored or exchanged between processes: they are only meant for in-memory
+    tables. None of these paths is suitable for cryptographic purpose or for
+    tables fed with keys crafted by an attacker.
+*/
+
+typedef enum {
+    HASH_PATH_FNV1A,
+    HASH_PATH_MULTIPLY,
+    HASH_PATH_CRC32C
+} hash_path_t;
+
+// calculate a 64-bit hash on a buffer using the selected path
+extern uint64_t hash_64( uint8_t *data, size_t len );
+
+// return the currently selected path
+extern hash_path_t hash_64_path( void );
+
+// return the name of the currently selected path ("fnv1a", "multiply" or
+// "crc32c"), for logging.
+extern const char *hash_64_path_name( void );
+
+// force the path used by hash_64. It returns false if the path is not
+// supported by the CPU, in which case the selected path is not changed. This
+// must be done before hashing any key that is kept in a table.
+extern bool hash_64_select( hash_path_t path );
+
+#endif /* __HASH_H__ */
@@ -0,0 +1,643 @@
+
+/*
+    Hash function benchmark suite.
+
+    It compares the library hash functions (and the identity hash used by maps
+    for pointer keys when no hash function is given) in 5 sections, that can
+    be selected by giving their names as arguments (all sections by default):
+
+    throughput  for each key size, each hash function is called on keys taken
+                at varying offsets in a random buffer until about BENCH_BYTES
+                bytes have been hashed. The throughput is given in MB/s, in ns
+                per key and in bytes per cycle (time stamp counter cycles, on
+                x86 only). Then for short keys, hashing BATCH_KEYS keys one at
+                a time with fnv1a_64 is compared with fnv1a_64_batch and with
+                fnv1a_64_batch_fixed.
+
+    avalanche   for random keys of various sizes, each input bit is flipped and
+                the probability that each output bit flips is measured. The
+                bias is 2 * | p - 0.5 |, from 0 (ideal) to 1 (the output bit
+                never or always flips). The worst and average biases over all
+                input/output bit pairs are given.
+
+    bias        for each key set, the probability that each output bit is set
+                is measured, and the worst bias 2 * | p - 0.5 | is given.
+
+    collisions  for each key set and each table size, keys are distributed
+                in buckets as in map_t (hash modulo the largest prime below
+                the table size), with 3/4 as many keys as buckets, as in a full
+                map_t. The number of colliding keys is given relative to the
+                number expected from a random function (1.00 is ideal), along
+                with the number of full 64-bit collisions.
+
+    map         for each key set, MAP_KEYS keys are inserted in a map_t using
+                each hash function, and the resulting map statistics (see
+                map_get_stats) are given: average and worst probe lengths, and
+                how many times the table was re-allocated.
+
+    Key sets are sequential 8-byte integers, random 8-byte integers, pointer-
+    like 8-byte values (48 bytes apart), short text keys ("user:<n>") and
+    12-byte keys made of a sequential 8-byte integer followed by 4 random
+    bytes (catching hash functions that are linear over words, which have
+    full 64-bit collisions on such keys). The identity hash only applies to
+    8-byte keys.
+
+    Build with: make OPTIMIZE=-O2 hash_bench
+    Run with:   ./hash_bench [throughput] [avalanche] [bias] [collisions] [map]
+*/
+
+#define _POSIX_C_SOURCE 199309L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+#include "fnv.h"
+#include "fx.h"
+#include "xxh64.h"
+#include "hash.h"
+#include "siphash.h"
+#include "map.h"
+
+#define BENCH_BYTES     (256 * 1024 * 1024)
+#define BUFFER_SIZE     (64 * 1024)
+#define BATCH_KEYS      1024
+#define AVALANCHE_KEYS  2000
+#define BIAS_KEYS       (1 << 18)
+#define MAP_KEYS        (1 << 20)
+#define MAX_TEXT_SIZE   16
+
+#if defined( __GNUC__ ) && ( defined( __x86_64__ ) || defined( __i386__ ) )
+#define HAS_TSC 1
+#else
+#define HAS_TSC 0
+#endif
+
+typedef uint64_t (*bench_hash_fct)( uint8_t *data, size_t len );
+
+// identity hash, as used by map_t for pointer keys without hash function
+static uint64_t identity( uint8_t *data, size_t len )
+{
+    uint64_t value = 0;
+    memcpy( &value, data, ( len < 8 ) ? len : 8 );
+    return value;
+}
+
+typedef struct {
+    const char      *name;
+    bench_hash_fct  hash;
+    bool            word_only;      // only meaningful for 8-byte keys
+} bench_hash_t;
+
+static const bench_hash_t hashes[] = {
+    { "identity",   identity,   true },
+    { "fnv1a_64",   fnv1a_64,   false },
+    { "fxhash_64",  fxhash_64,  false },
+    { "xxh64",      xxh64,      false },
+    { "hash_64",    hash_64,    false },
+    { "siphash_64", siphash_64, false },
+};
+
+static const size_t key_sizes[] = { 4, 8, 16, 32, 64, 256, 1024, 4096 };
+static const size_t batch_key_sizes[] = { 8, 16, 32 };
+static const size_t avalanche_key_sizes[] = { 4, 8, 16, 64 };
+static const uint32_t table_sizes[] = { 1 << 12, 1 << 16, 1 << 20,
+                                        1 << 22 };
+
+#define ARRAY_SIZE( a ) ( sizeof(a) / sizeof(a[0]) )
+
+/* ----------------------------- utilities ---------------------------- */
+
+static double now( void )
+{
+    struct timespec ts;
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+static inline uint64_t cycles( void )
+{
+#if HAS_TSC
+    return __builtin_ia32_rdtsc();
+#else
+    return 0;
+#endif
+}
+
+static volatile uint64_t sink;      // prevent optimizing hash calls away
+
+static uint64_t rng_state = 0x9e3779b97f4a7c15;
+
+static uint64_t rng( void )         // xorshift64*
+{
+    rng_state ^= rng_state >> 12;
+    rng_state ^= rng_state << 25;
+    rng_state ^= rng_state >> 27;
+    return rng_state * 0x2545f4914f6cdd1d;
+}
+
+static void fill_random( uint8_t *data, size_t len )
+{
+    for ( size_t i = 0; i < len; ++i ) {
+        data[i] = (uint8_t)( rng() >> 56 );
+    }
+}
+
+static int compare_hashes( const void *item1, const void *item2 )
+{
+    uint64_t h1 = *(const uint64_t *)item1, h2 = *(const uint64_t *)item2;
+    return ( h1 < h2 ) ? -1 : ( h1 > h2 );
+}
+
+/* ------------------------------ key sets ---------------------------- */
+
+typedef enum { SEQUENTIAL, RANDOM, POINTER, TEXT, TAILED } key_set_t;
+
+#define KEY_SETS        ( TAILED + 1 )
+
+static const char *key_set_names[] = { "sequential", "random", "pointer",
+                                       "text", "tailed" };
+
+typedef struct {
+    uint8_t     *data;
+    size_t      len;
+} bench_key_t;
+
+typedef struct {
+    key_set_t   set;
+    size_t      n;
+    bench_key_t *keys;
+    uint8_t     *buffer;
+} key_list_t;
+
+static bool make_keys( key_list_t *list, key_set_t set, size_t n )
+{
+    size_t size = 8;
+    if ( TEXT == set ) size = MAX_TEXT_SIZE;
+    if ( TAILED == set ) size = 12;
+    list->set = set;
+    list->n = n;
+    list->keys = malloc( sizeof(bench_key_t) * n );
+    list->buffer = malloc( size * n );
+    if ( NULL == list->keys || NULL == list->buffer ) {
+        free( list->keys );
+        free( list->buffer );
+        return false;
+    }
+
+    for ( size_t i = 0; i < n; ++i ) {
+        uint8_t *data = list->buffer + i * size;
+        uint64_t value = 0;
+        size_t len = 8;
+
+        switch ( set ) {
+        case SEQUENTIAL:    value = i + 1;                          break;
+        case RANDOM:        value = rng();                          break;
+        case POINTER:       value = 0x7f3a5c000010 + i * 48;        break;
+        case TEXT:
+            len = (size_t)sprintf( (char *)data, "user:%zu", i );
+            break;
+        case TAILED: {
+            uint32_t tail = (uint32_t)rng();
+            value = i + 1;
+            memcpy( data + 8, &tail, 4 );
+            len = 12;
+            break;
+        }
+        }
+        if ( TEXT != set ) {
+            memcpy( data, &value, 8 );
+        }
+        list->keys[i].data = data;
+        list->keys[i].len = len;
+    }
+    return true;
+}
+
+static void free_keys( key_list_t *list )
+{
+    free( list->keys );
+    free( list->buffer );
+}
+
+// make n keys of each set, or none in case of failure (no memory)
+static bool make_all_keys( key_list_t lists[KEY_SETS], size_t n )
+{
+    for ( key_set_t set = SEQUENTIAL; set < KEY_SETS; ++set ) {
+        if ( ! make_keys( &lists[set], set, n ) ) {
+            while ( set-- > SEQUENTIAL ) {
+                free_keys( &lists[set] );
+            }
+            return false;
+        }
+    }
+    return true;
+}
+
+static void free_all_keys( key_list_t lists[KEY_SETS] )
+{
+    for ( key_set_t set = SEQUENTIAL; set < KEY_SETS; ++set ) {
+        free_keys( &lists[set] );
+    }
+}
+
+static bool applies( const bench_hash_t *hash, key_set_t set )
+{
+    return ! hash->word_only || ( TEXT != set && TAILED != set );
+}
+
+/* ----------------------------- throughput --------------------------- */
+
+static double bench( bench_hash_fct hash, uint8_t *buffer, size_t len,
+                     double *bytes_per_cycle )
+{
+    size_t n = BENCH_BYTES / len;
+    size_t range = BUFFER_SIZE - len;
+    uint64_t result = 0;
+
+    double start = now();
+    uint64_t start_cycles = cycles();
+    for ( size_t i = 0; i < n; ++i ) {
+        result ^= hash( buffer + ( ( i * 64 ) % range ), len );
+    }
+    uint64_t elapsed_cycles = cycles() - start_cycles;
+    double elapsed = now() - start;
+
+    sink = result;
+    *bytes_per_cycle = ( elapsed_cycles ) ?
+                    (double)n * (double)len / (double)elapsed_cycles : 0.0;
+    return elapsed / (double)n;     // seconds per key
+}
+
+typedef enum { ONE_AT_A_TIME, BATCH, BATCH_FIXED } batch_mode_t;
+
+static double bench_batch( batch_mode_t mode, uint8_t *buffer, size_t len )
+{
+    uint8_t *keys[BATCH_KEYS];
+    size_t lens[BATCH_KEYS];
+    uint64_t out[BATCH_KEYS];
+
+    size_t range = BUFFER_SIZE - len;
+    for ( size_t i = 0; i < BATCH_KEYS; ++i ) {
+        keys[i] = buffer + ( ( i * 64 ) % range );
+        lens[i] = len;
+    }
+
+    size_t rounds = BENCH_BYTES / ( len * BATCH_KEYS );
+    uint64_t result = 0;
+
+    double start = now();
+    for ( size_t r = 0; r < rounds; ++r ) {
+        switch ( mode ) {
+        case ONE_AT_A_TIME:
+            for ( size_t i = 0; i < BATCH_KEYS; ++i ) {
+                out[i] = fnv1a_64( keys[i], lens[i] );
+            }
+            break;
+        case BATCH:
+            fnv1a_64_batch( keys, lens, BATCH_KEYS, out );
+            break;
+        case BATCH_FIXED:
+            fnv1a_64_batch_fixed( keys, len, BATCH_KEYS, out );
+            break;
+        }
+        result ^= out[ r % BATCH_KEYS ];
+    }
+    double elapsed = now() - start;
+
+    sink = result;
+    return elapsed / (double)( rounds * BATCH_KEYS );
+}
+
+static void throughput( void )
+{
+    uint8_t *buffer = malloc( BUFFER_SIZE );
+    if ( NULL == buffer ) return;
+    fill_random( buffer, BUFFER_SIZE );
+
+    printf( "Throughput (hash_64 path: %s)\n\n", hash_64_path_name() );
+    printf( "%-12s %8s %12s %12s %12s\n", "hash", "key size", "MB/s",
+            "ns/key", HAS_TSC ? "bytes/cycle" : "" );
+    for ( size_t s = 0; s < ARRAY_SIZE( key_sizes ); ++s ) {
+        for ( size_t h = 0; h < ARRAY_SIZE( hashes ); ++h ) {
+            if ( hashes[h].word_only ) continue;
+
+            double bpc;
+            double t = bench( hashes[h].hash, buffer, key_sizes[s], &bpc );
+            printf( "%-12s %8zu %12.1f %12.2f", hashes[h].name, key_sizes[s],
+                    (double)key_sizes[s] / t / 1e6, t * 1e9 );
+            if ( HAS_TSC ) {
+                printf( " %12.3f", bpc );
+            }
+            printf( "\n" );
+        }
+    }
+
+    static const char *batch_names[] = { "fnv1a_64", "batch", "batch_fixed" };
+    printf( "\n%-12s %8s %12s %12s\n", "fnv1a_64", "key size", "MB/s",
+            "ns/key" );
+    for ( size_t s = 0; s < ARRAY_SIZE( batch_key_sizes ); ++s ) {
+        for ( int mode = ONE_AT_A_TIME; mode <= BATCH_FIXED; ++mode ) {
+            double t = bench_batch( mode, buffer, batch_key_sizes[s] );
+            printf( "%-12s %8zu %12.1f %12.2f\n", batch_names[mode],
+                    batch_key_sizes[s],
+                    (double)batch_key_sizes[s] / t / 1e6, t * 1e9 );
+        }
+    }
+    printf( "\n" );
+    free( buffer );
+}
+
+/* ----------------------------- avalanche ---------------------------- */
+
+static void avalanche_test( const bench_hash_t *hash, size_t len,
+                            double *worst, double *average )
+{
+    size_t nbits = len * 8;
+    uint32_t *flips = calloc( nbits * 64, sizeof(uint32_t) );
+    uint8_t key[64];
+    if ( NULL == flips ) return;
+
+    for ( size_t k = 0; k < AVALANCHE_KEYS; ++k ) {
+        fill_random( key, len );
+        uint64_t h0 = hash->hash( key, len );
+
+        for ( size_t i = 0; i < nbits; ++i ) {
+            key[i / 8] ^= (uint8_t)( 1 << ( i % 8 ) );
+            uint64_t diff = h0 ^ hash->hash( key, len );
+            key[i / 8] ^= (uint8_t)( 1 << ( i % 8 ) );
+
+            uint32_t *counts = &flips[ i * 64 ];
+            for ( int j = 0; j < 64; ++j ) {
+                counts[j] += (uint32_t)( ( diff >> j ) & 1 );
+            }
+        }
+    }
+
+    double sum = 0.0, max = 0.0;
+    for ( size_t c = 0; c < nbits * 64; ++c ) {
+        double bias = 2.0 * fabs( (double)flips[c] / AVALANCHE_KEYS - 0.5 );
+        sum += bias;
+        if ( bias > max ) max = bias;
+    }
+    *worst = max;
+    *average = sum / (double)( nbits * 64 );
+    free( flips );
+}
+
+static void avalanche( void )
+{
+    printf( "Avalanche (bias from 0: ideal to 1: worst, over %d random keys)"
+            "\n\n", AVALANCHE_KEYS );
+    printf( "%-12s %8s %12s %12s\n", "hash", "key size", "worst", "average" );
+    for ( size_t s = 0; s < ARRAY_SIZE( avalanche_key_sizes ); ++s ) {
+        size_t len = avalanche_key_sizes[s];
+        for ( size_t h = 0; h < ARRAY_SIZE( hashes ); ++h ) {
+            if ( hashes[h].word_only && 8 != len ) continue;
+
+            double worst = 0.0, average = 0.0;
+            avalanche_test( &hashes[h], len, &worst, &average );
+            printf( "%-12s %8zu %12.3f %12.3f\n", hashes[h].name, len,
+                    worst, average );
+        }
+    }
+    printf( "\n" );
+}
+
+/* -------------------------------- bias ------------------------------ */
+
+static double bias_test( const bench_hash_t *hash, const key_list_t *list )
+{
+    uint32_t ones[64] = { 0 };
+
+    for ( size_t k = 0; k < list->n; ++k ) {
+        uint64_t h = hash->hash( list->keys[k].data, list->keys[k].len );
+        for ( int j = 0; j < 64; ++j ) {
+            ones[j] += (uint32_t)( ( h >> j ) & 1 );
+        }
+    }
+
+    double max = 0.0;
+    for ( int j = 0; j < 64; ++j ) {
+        double bias = 2.0 * fabs( (double)ones[j] / (double)list->n - 0.5 );
+        if ( bias > max ) max = bias;
+    }
+    return max;
+}
+
+static void bias( void )
+{
+    printf( "Output bit bias (worst over 64 bits, %d keys)\n\n", BIAS_KEYS );
+    printf( "%-12s", "hash" );
+    for ( key_set_t set = SEQUENTIAL; set < KEY_SETS; ++set ) {
+        printf( " %12s", key_set_names[set] );
+    }
+    printf( "\n" );
+
+    key_list_t lists[KEY_SETS];
+    if ( ! make_all_keys( lists, BIAS_KEYS ) ) return;
+    for ( size_t h = 0; h < ARRAY_SIZE( hashes ); ++h ) {
+        printf( "%-12s", hashes[h].name );
+        for ( key_set_t set = SEQUENTIAL; set < KEY_SETS; ++set ) {
+            if ( applies( &hashes[h], set ) ) {
+                printf( " %12.3f", bias_test( &hashes[h], &lists[set] ) );
+            } else {
+                printf( " %12s", "-" );
+            }
+        }
+        printf( "\n" );
+    }
+    free_all_keys( lists );
+    printf( "\n" );
+}
+
+/* ----------------------------- collisions --------------------------- */
+
+// largest prime below size, as map_t uses for its modulo
+static uint32_t largest_prime_below( uint32_t size )
+{
+    for ( uint32_t p = size - 1; p > 2; --p ) {
+        bool prime = ( p & 1 );
+        for ( uint32_t d = 3; prime && d * d <= p; d += 2 ) {
+            if ( 0 == p % d ) prime = false;
+        }
+        if ( prime ) return p;
+    }
+    return 2;
+}
+
+static void collision_test( const bench_hash_t *hash, const key_list_t *list,
+                            uint32_t modulo, double *ratio, size_t *full )
+{
+    uint8_t *used = calloc( modulo, 1 );
+    uint64_t *values = malloc( sizeof(uint64_t) * list->n );
+    if ( NULL == used || NULL == values ) {
+        free( used );
+        free( values );
+        return;
+    }
+
+    size_t collisions = 0;
+    for ( size_t k = 0; k < list->n; ++k ) {
+        uint64_t h = hash->hash( list->keys[k].data, list->keys[k].len );
+        values[k] = h;
+        uint32_t index = (uint32_t)( h % modulo );
+        if ( used[index] ) {
+            ++collisions;
+        } else {
+            used[index] = 1;
+        }
+    }
+
+    // expected colliding keys for n keys randomly thrown in m buckets
+    double n = (double)list->n, m = (double)modulo;
+    double expected = n - m * ( 1.0 - pow( 1.0 - 1.0 / m, n ) );
+    *ratio = (double)collisions / expected;
+
+    qsort( values, list->n, sizeof(uint64_t), compare_hashes );
+    *full = 0;
+    for ( size_t k = 1; k < list->n; ++k ) {
+        if ( values[k] == values[k-1] ) ++*full;
+    }
+    free( used );
+    free( values );
+}
+
+static void collisions( void )
+{
+    printf( "Bucket collisions (actual / expected, full 64-bit collisions)"
+            "\n\n" );
+    for ( size_t t = 0; t < ARRAY_SIZE( table_sizes ); ++t ) {
+        uint32_t modulo = largest_prime_below( table_sizes[t] );
+        size_t n = ( 3 * (size_t)table_sizes[t] ) / 4;
+
+        printf( "table size %u, modulo %u, %zu keys\n", table_sizes[t],
+                modulo, n );
+        printf( "%-12s", "hash" );
+        for ( key_set_t set = SEQUENTIAL; set < KEY_SETS; ++set ) {
+            printf( " %16s", key_set_names[set] );
+        }
+        printf( "\n" );
+
+        key_list_t lists[KEY_SETS];
+        if ( ! make_all_keys( lists, n ) ) return;
+        for ( size_t h = 0; h < ARRAY_SIZE( hashes ); ++h ) {
+            printf( "%-12s", hashes[h].name );
+            for ( key_set_t set = SEQUENTIAL; set < KEY_SETS; ++set ) {
+                if ( applies( &hashes[h], set ) ) {
+                    double ratio = 0.0;
+                    size_t full = 0;
+                    collision_test( &hashes[h], &lists[set], modulo,
+                                    &ratio, &full );
+                    printf( " %8.2f %7zu", ratio, full );
+                } else {
+                    printf( " %16s", "-" );
+                }
+            }
+            printf( "\n" );
+        }
+        free_all_keys( lists );
+        printf( "\n" );
+    }
+}
+
+/* --------------------------------- map ------------------------------ */
+
+static bench_hash_fct map_hash;     // hash function used by map_key_hash
+
+static uint64_t map_key_hash( const void *key )
+{
+    const bench_key_t *k = key;
+    return map_hash( k->data, k->len );
+}
+
+static bool map_key_same( const void *key1, const void *key2 )
+{
+    const bench_key_t *k1 = key1, *k2 = key2;
+    return k1->len == k2->len && 0 == memcmp( k1->data, k2->data, k1->len );
+}
+
+static void map_test( const bench_hash_t *hash, const key_list_t *list,
+                      map_stats_t *stats, double *elapsed )
+{
+    map_t *map;
+    double start = now();
+
+    if ( identity == hash->hash ) {     // map_t built-in pointer hash
+        map = new_map( NULL, NULL, 0, 4 );
+        for ( size_t k = 0; NULL != map && k < list->n; ++k ) {
+            uint64_t value;
+            memcpy( &value, list->keys[k].data, 8 );
+            map_insert_entry( map, (void *)(uintptr_t)value, NULL );
+        }
+    } else {
+        map_hash = hash->hash;
+        map = new_map( map_key_hash, map_key_same, 0, 4 );
+        for ( size_t k = 0; NULL != map && k < list->n; ++k ) {
+            map_insert_entry( map, &list->keys[k], NULL );
+        }
+    }
+    *elapsed = now() - start;
+    memset( stats, 0, sizeof(map_stats_t) );
+    map_get_stats( map, stats );
+    map_free( map );
+}
+
+static void map( void )
+{
+    printf( "map_t with %d keys (average probes, worst probes, rehashes, "
+            "build time in ms)\n\n", MAP_KEYS );
+    printf( "%-12s %-10s %10s %10s %10s %10s\n", "hash", "keys", "avg",
+            "worst", "rehashes", "ms" );
+
+    for ( key_set_t set = SEQUENTIAL; set < KEY_SETS; ++set ) {
+        key_list_t list;
+        if ( ! make_keys( &list, set, MAP_KEYS ) ) return;
+
+        for ( size_t h = 0; h < ARRAY_SIZE( hashes ); ++h ) {
+            if ( ! applies( &hashes[h], set ) ) continue;
+
+            map_stats_t stats;
+            double elapsed;
+            map_test( &hashes[h], &list, &stats, &elapsed );
+            printf( "%-12s %-10s %10.3f %10u %10u %10.1f\n", hashes[h].name,
+                    key_set_names[set], stats.avg_probe, stats.max_probe,
+                    stats.rehashes, elapsed * 1e3 );
+        }
+        free_keys( &list );
+    }
+    printf( "\n" );
+}
+
+/* --------------------------------- main ----------------------------- */
+
+typedef struct {
+    const char  *name;
+    void        (*run)( void );
+} section_t;
+
+static const section_t sections[] = {
+    { "throughput", throughput },
+    { "avalanche",  avalanche },
+    { "bias",       bias },
+    { "collisions", collisions },
+    { "map",        map },
+};
+
+int main( int argc, char **argv )
+{
+    for ( size_t s = 0; s < ARRAY_SIZE( sections ); ++s ) {
+        bool selected = ( argc < 2 );
+        for ( int a = 1; a < argc; ++a ) {
+            if ( 0 == strcmp( argv[a], sections[s].name ) ) selected = true;
+        }
+        if ( selected ) {
+            sections[s].run();
+        }
+    }
+    return 0;
+}
@@ -12,6 +12,7 @@
 struct heap {
     slice_t *slice;
     cmp_fct cmp;
+    const allocator_t *allocator;   // for the heap header
 };
 
 /* percolate_up assumes the heap property was estabished before a new item was
@@ -242,20 +243,28 @@ extern void *heap_extract_then_insert( heap_t *heap, void* data )
 
 static inline heap_t *new_heap_with_slice_n_cmp( slice_t *slice, cmp_fct cmp )
 {
-    heap_t *heap = malloc( sizeof( heap_t ) );
+    heap_t *heap = allocator_alloc( slice->allocator, sizeof( heap_t ) );
     if ( NULL != heap ) {
         heap->slice = slice;
         heap->cmp = cmp;
+        heap->allocator = slice->allocator;
     }
     return heap;
 }
 
 extern heap_t *new_heap( size_t number, cmp_fct cmp )
+{
+    return new_heap_with_allocator( number, cmp, NULL );
+}
+
+extern heap_t *new_heap_with_allocator( size_t number, cmp_fct cmp,
+                                        const allocator_t *allocator )
 {
     if ( NULL == cmp ) return NULL;
 
     heap_t *heap = NULL;
-    slice_t *slice = new_slice( sizeof( void *), number );
+    slice_t *slice = new_slice_with_allocator( sizeof( void *), number,
+                                               allocator );
     if ( NULL != slice ) {
         heap = new_heap_with_slice_n_cmp( slice, cmp );
         if ( NULL == heap ) {
@@ -294,7 +303,7 @@ extern heap_t *new_heap_from_data( const void **data,
 extern void heap_free( heap_t *heap )
 {
     slice_free( heap->slice );
-    free( heap );
+    allocator_free( heap->allocator, heap, sizeof( heap_t ) );
 }
 
 extern void heap_process_items( const heap_t *heap, item_process_fct fct,
@@ -51,6 +51,11 @@ typedef int (*cmp_fct)( void *item1, void *item2 );
 
 extern heap_t *new_heap( size_t number, cmp_fct cmp );
 
+// same as new_heap, but the heap and its array are allocated with the given
+// allocator (see alloc.h), or with the default allocator if it is NULL.
+extern heap_t *new_heap_with_allocator( size_t number, cmp_fct cmp,
+                                        const allocator_t *allocator );
+
 // create a hew heap for initially number (void *)elements and store the
 // comparison function to call while sorting. The data passed is a pointer
 // to an array of object pointers, which are copied into the heap before it
@@ -0,0 +1,249 @@
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "slice.h"
+#include "_slice.h"
+#include "join.h"
+#include "partition.h"
+#include "_partition.h"
+
+// target number of build rows per partition in partitioned mode, so that the
+// partition hash table and rows fit in a typical L2 cache.
+#define JOIN_PARTITION_ROWS     4096
+// number of probe rows whose buckets are prefetched together
+#define JOIN_BATCH              16
+
+#if defined( __GNUC__ )
+#define PREFETCH( addr )        __builtin_prefetch( addr )
+#else
+#define PREFETCH( addr )
+#endif
+
+#define NO_ROW                  ((size_t)-1)
+
+typedef struct {
+    same_fct                same;
+    join_type_t             type;
+    bool                    swapped;    // true if left is the build side
+    const partition_row_t   *rows;      // build rows
+    size_t                  *heads;     // table heads: row index + 1 or 0
+    size_t                  *next;      // next row index + 1 in bucket or 0
+    size_t                  *matched;   // first match for each left row
+    uint32_t                bits;       // partition bits
+    uint32_t                table_bits;
+    slice_t                 *result;
+    bool                    failed;
+} join_t;
+
+static inline bool same_key( const join_t *j,
+                             const void *key1, const void *key2 )
+{
+    return ( j->same ) ? j->same( key1, key2 ) : key1 == key2;
+}
+
+static uint32_t table_bits( size_t n )
+{
+    uint32_t bits = 1;
+    while ( ( (size_t)1 << bits ) < n ) ++bits;
+    return bits;
+}
+
+// build a chained hash table on n build rows. The heads and next arrays must
+// be large enough for n rows.
+static void build( join_t *j, const partition_row_t *rows, size_t n )
+{
+    j->rows = rows;
+    j->table_bits = table_bits( n );
+    memset( j->heads, 0, sizeof(size_t) << j->table_bits );
+
+    for ( size_t i = 0; i < n; ++i ) {
+        size_t slot = _partition_slot( rows[i].hash, j->bits, j->table_bits );
+        j->next[i] = j->heads[slot];
+        j->heads[slot] = i + 1;
+    }
+}
+
+static inline void emit( join_t *j, size_t probe_row, size_t build_row )
+{
+    if ( j->swapped && SEMI_JOIN == j->type ) {
+        if ( NO_ROW == j->matched[build_row] ) {
+            j->matched[build_row] = probe_row;
+        }
+        return;
+    }
+    join_pair_t pair;
+    if ( j->swapped ) {
+        pair.left = build_row;
+        pair.right = probe_row;
+    } else {
+        pair.left = probe_row;
+        pair.right = build_row;
+    }
+    if ( -1 == _slice_append_item( j->result, &pair ) ) {
+        j->failed = true;
+    }
+}
+
+// probe a batch of at most JOIN_BATCH rows in 3 steps: prefetch the buckets,
+// then prefetch the first row in each bucket and finally walk the buckets.
+static void probe_batch( join_t *j, const partition_row_t *probes, size_t n )
+{
+    size_t slots[JOIN_BATCH], firsts[JOIN_BATCH];
+
+    for ( size_t i = 0; i < n; ++i ) {
+        slots[i] = _partition_slot( probes[i].hash, j->bits, j->table_bits );
+        PREFETCH( &j->heads[ slots[i] ] );
+    }
+    for ( size_t i = 0; i < n; ++i ) {
+        firsts[i] = j->heads[ slots[i] ];
+        if ( firsts[i] ) {
+            PREFETCH( &j->rows[ firsts[i] - 1 ] );
+        }
+    }
+    for ( size_t i = 0; i < n; ++i ) {
+        const partition_row_t *probe = &probes[i];
+        for ( size_t e = firsts[i]; e; e = j->next[e-1] ) {
+            const partition_row_t *row = &j->rows[e-1];
+            if ( row->hash == probe->hash &&
+                 same_key( j, row->key, probe->key ) ) {
+                emit( j, probe->row, row->row );
+                if ( SEMI_JOIN == j->type && ! j->swapped ) break;
+            }
+        }
+    }
+}
+
+static void probe_rows( join_t *j, const partition_row_t *probes, size_t n )
+{
+    for ( size_t i = 0; i < n && ! j->failed; i += JOIN_BATCH ) {
+        probe_batch( j, &probes[i], ( n - i < JOIN_BATCH ) ? n - i
+                                                             : JOIN_BATCH );
+    }
+}
+
+// probe directly from the slice, calculating keys and hashes batch by batch
+static void probe_from_slice( join_t *j, const slice_t *slice,
+                              row_key_fct key, hash_fct hash )
+{
+    partition_row_t probes[JOIN_BATCH];
+    size_t n = _slice_len( slice );
+
+    for ( size_t i = 0; i < n && ! j->failed; ) {
+        size_t count = 0;
+        for ( ; count < JOIN_BATCH && i < n; ++count, ++i ) {
+            probes[count].key = key( _slice_item_at( slice, i ) );
+            probes[count].hash = ( hash ) ? hash( probes[count].key )
+                                          : (uint64_t)probes[count].key;
+            probes[count].row = i;
+        }
+        probe_batch( j, probes, count );
+    }
+}
+
+// with partitioned, both sides are partitioned, otherwise only the build side
+// is (in a single partition, just to get all keys and hashes)
+static bool join( join_t *j, const slice_t *build_slice, row_key_fct build_key,
+                  const slice_t *probe_slice, row_key_fct probe_key,
+                  hash_fct hash, bool partitioned )
+{
+    size_t n = _slice_len( build_slice );
+    j->bits = ( partitioned ) ? partition_bits( n, JOIN_PARTITION_ROWS ) : 0;
+
+    partition_t *builds = new_partition( build_slice, build_key, hash,
+                                         j->bits, 1 );
+    partition_t *probes = NULL;
+    if ( partitioned ) {
+        probes = new_partition( probe_slice, probe_key, hash, j->bits, 1 );
+    }
+
+    size_t max = 0;
+    for ( size_t p = 0; NULL != builds && p < _partition_count( builds ); ++p ) {
+        size_t len;
+        _partition_rows( builds, p, &len );
+        if ( len > max ) max = len;
+    }
+    j->heads = malloc( sizeof(size_t) << table_bits( max ) );
+    j->next = malloc( sizeof(size_t) * ( max ? max : 1 ) );
+
+    bool done = NULL != builds && ( ! partitioned || NULL != probes ) &&
+                NULL != j->heads && NULL != j->next;
+    if ( done ) {
+        for ( size_t p = 0; p < _partition_count( builds ); ++p ) {
+            size_t n_build, n_probe = 0;
+            const partition_row_t *rows = _partition_rows( builds, p,
+                                                           &n_build );
+            if ( 0 == n_build ) continue;
+
+            build( j, rows, n_build );
+            if ( partitioned ) {
+                const partition_row_t *prows = _partition_rows( probes, p,
+                                                                &n_probe );
+                probe_rows( j, prows, n_probe );
+            } else {
+                probe_from_slice( j, probe_slice, probe_key, hash );
+            }
+        }
+        done = ! j->failed;
+    }
+    free( j->heads );
+    free( j->next );
+    partition_free( builds );
+    partition_free( probes );
+    return done;
+}
+
+extern slice_t *slice_hash_join( const slice_t *left, row_key_fct left_key,
+                                 const slice_t *right, row_key_fct right_key,
+                                 hash_fct hash, same_fct same,
+                                 join_type_t type, bool partitioned )
+{
+    if ( NULL == left || NULL == left_key || NULL == right ||
+         NULL == right_key || ( NULL != hash && NULL == same ) ||
+         ( INNER_JOIN != type && SEMI_JOIN != type ) ) {
+        return NULL;
+    }
+
+    join_t j = { .same = same, .type = type };
+    j.swapped = _slice_len( left ) < _slice_len( right );
+    j.result = new_slice( sizeof(join_pair_t), 0 );
+    if ( NULL == j.result ) return NULL;
+
+    size_t n_left = _slice_len( left );
+    if ( j.swapped && SEMI_JOIN == type ) {
+        j.matched = malloc( sizeof(size_t) * ( n_left ? n_left : 1 ) );
+        if ( NULL == j.matched ) {
+            slice_free( j.result );
+            return NULL;
+        }
+        for ( size_t i = 0; i < n_left; ++i ) {
+            j.matched[i] = NO_ROW;
+        }
+    }
+
+    bool done;
+    if ( j.swapped ) {
+        done = join( &j, left, left_key, right, right_key, hash, partitioned );
+    } else {
+        done = join( &j, right, right_key, left, left_key, hash, partitioned );
+    }
+
+    if ( done && NULL != j.matched ) {      // emit matched left rows
+        for ( size_t i = 0; i < n_left; ++i ) {
+            if ( NO_ROW == j.matched[i] ) continue;
+
+            join_pair_t pair = { i, j.matched[i] };
+            if ( -1 == _slice_append_item( j.result, &pair ) ) {
+                done = false;
+                break;
+            }
+        }
+    }
+    free( j.matched );
+    if ( ! done ) {
+        slice_free( j.result );
+        return NULL;
+    }
+    return j.result;
+}
@@ -0,0 +1,57 @@
+
+#ifndef __JOIN_H__
+#define __JOIN_H__
+
+#include <stddef.h>
+#include <stdbool.h>
+
+#include "slice.h"
+#include "map.h"
+#include "partition.h"
+
+/*
+    Hash join of the items (rows) of two slices.
+
+    Each row of the left and right slices is given a key by a user function
+    (see partition.h) and rows are matched when their keys are the same. The
+    join result is a slice of join_pair_t items, giving the indexes of matching
+    left and right rows.
+
+    The hash table is built on the smaller side, and rows from the other side
+    are probed in batches: the table buckets for a whole batch are prefetched
+    before any of them is accessed, so that cache misses overlap.
+
+    In partitioned mode, both sides are first radix-partitioned by key hash
+    with the same number of partitions (see partition.h), so that each build
+    side partition has a hash table small enough to stay in cache, and each
+    probe side partition is joined only with the corresponding build side
+    partition. This is faster when the build side is much larger than the
+    cache, at the expense of partitioning both sides first.
+
+    As for maps, if the hash function is NULL the hash value of a key is just
+    its pointer cast as uint64_t and keys are compared as pointers.
+*/
+
+typedef enum {
+    INNER_JOIN,                 // all pairs of matching rows
+    SEMI_JOIN                   // left rows with at least one matching row
+} join_type_t;
+
+typedef struct {
+    size_t      left;           // row index in left slice
+    size_t      right;          // row index in right slice
+} join_pair_t;
+
+// join left and right slices and return a new slice of join_pair_t. For an
+// inner join, all pairs of matching rows are returned. For a semi join, each
+// left row with at least one match is returned once, paired with one of its
+// matching right rows. The order of pairs in the result is not specified. If
+// hash is not NULL, same must be given as well. It returns NULL in case of
+// failure (no memory or bad arguments). The returned slice must be freed by
+// calling slice_free.
+extern slice_t *slice_hash_join( const slice_t *left, row_key_fct left_key,
+                                 const slice_t *right, row_key_fct right_key,
+                                 hash_fct hash, same_fct same,
+                                 join_type_t type, bool partitioned );
+
+#endif /* __JOIN_H__ */
@@ -3,10 +3,14 @@
 #include <string.h>
 #include <stdio.h>
 #include <malloc.h>
+#include <stdlib.h>
 
 #include "slice.h"
 #include "_slice.h"
 #include "map.h"
+#include "parallel.h"
+#include "siphash.h"
+#include "slab.h"
 
 typedef struct _map_entry {
     struct _map_entry *next;    // linked list in case of collisions
@@ -24,8 +28,26 @@ struct map {
     uint32_t            modulo;
     uint32_t            max_collision;
     uint32_t            threshold;
+    uint32_t            rehashes;
+    const allocator_t   *allocator; // for the map, table and entries
+    slab_t              *entries;   // entry cache with the malloc allocator
 };
 
+static inline map_entry_t *alloc_entry( const map_t *map )
+{
+    if ( map->entries ) return slab_alloc( map->entries );
+    return allocator_alloc( map->allocator, sizeof(map_entry_t) );
+}
+
+static inline void free_entry( const map_t *map, map_entry_t *entry )
+{
+    if ( map->entries ) {
+        slab_release( map->entries, entry );
+    } else {
+        allocator_free( map->allocator, entry, sizeof(map_entry_t) );
+    }
+}
+
 #define MIN_ALLOCATED   8       // must be power of 2
 #define MIN_MODULO      7       // largest prime less then MIN_ALLOCATED
 #define MIN_COLLISIONS  4       // Allways accept at least MIN_COLLISIONS
@@ -91,16 +113,30 @@ static uint32_t round_up_2power( uint32_t size )
 extern map_t *new_map( hash_fct hash, same_fct same,
                        uint32_t size, uint32_t collisions )
 {
-    map_t *map = malloc( sizeof(map_t) );
+    return new_map_with_allocator( hash, same, size, collisions, NULL );
+}
+
+extern map_t *new_map_with_allocator( hash_fct hash, same_fct same,
+                                      uint32_t size, uint32_t collisions,
+                                      const allocator_t *allocator )
+{
+    if ( NULL == allocator ) allocator = default_allocator( );
+    if ( NULL == allocator->alloc ) return NULL;
+
+    map_t *map = allocator_alloc( allocator, sizeof(map_t) );
     if ( NULL == map ) {
         return NULL;
     }
+    map->allocator = allocator;
+    map->entries = ( allocator == malloc_allocator( ) ) ?
+                        shared_slab( sizeof(map_entry_t) ) : NULL;
 
     if ( 0 != size ) {
         size = round_up_2power( size );
-        map_entry_t *table = malloc( sizeof(map_entry_t) * size );
+        map_entry_t *table = allocator_alloc( allocator,
+                                              sizeof(map_entry_t) * size );
         if ( NULL == table ) {
-            free( map );
+            allocator_free( allocator, map, sizeof(map_t) );
             return NULL;
         }
         memset( (void *)table, 0, sizeof(map_entry_t) * size );
@@ -116,6 +152,7 @@ extern map_t *new_map( hash_fct hash, same_fct same,
     map->same_f = same;
     map->nb = 0;
     map->max_collision = 0;
+    map->rehashes = 0;
 
     if ( collisions >= MIN_COLLISIONS ) {
         map->threshold = collisions;
@@ -125,33 +162,54 @@ extern map_t *new_map( hash_fct hash, same_fct same,
     return map;
 }
 
-static void free_table( map_entry_t *table, uint32_t allocated )
+extern uint64_t map_string_hash( const void *key )
 {
-    for ( uint32_t i = 0; i < allocated; ++i ) {
-        map_entry_t *entry = &table[ i ];
+    return siphash_64( (uint8_t *)key, strlen( (const char *)key ) );
+}
 
-        if ( entry->key ) { /* a valid  entry */
-            map_entry_t *next;
-            for ( entry = entry->next; entry != NULL; entry = next ) {
-                next = entry->next;
-                free( entry );
+extern bool map_string_same( const void *key1, const void *key2 )
+{
+    return 0 == strcmp( (const char *)key1, (const char *)key2 );
+}
+
+extern map_t *new_string_map( uint32_t size, uint32_t collisions )
+{
+    return new_map( map_string_hash, map_string_same, size, collisions );
+}
+
+static void free_table( const map_t *map, map_entry_t *table,
+                        uint32_t allocated )
+{
+    if ( NULL == table ) return;
+
+    if ( map->allocator->free ) {   // nothing to do in region mode
+        for ( uint32_t i = 0; i < allocated; ++i ) {
+            map_entry_t *entry = &table[ i ];
+
+            if ( entry->key ) { /* a valid  entry */
+                map_entry_t *next;
+                for ( entry = entry->next; entry != NULL; entry = next ) {
+                    next = entry->next;
+                    free_entry( map, entry );
+                }
             }
         }
     }
-    free( table );
+    allocator_free( map->allocator, table, sizeof(map_entry_t) * allocated );
 }
 
 extern int map_free( map_t *map )
 {
     if ( NULL == map ) return -1;
 
-    free_table( map->table, map->allocated );
-    free( map );
+    free_table( map, map->table, map->allocated );
+    allocator_free( map->allocator, map, sizeof(map_t) );
     return 0;
 }
 
-static unsigned int add_entry( map_entry_t *entry, uint64_t hash,
-                               const void *key, const void *data )
+static unsigned int add_entry( const map_t *map, map_entry_t *entry,
+                               uint64_t hash, const void *key,
+                               const void *data )
 {
     unsigned int count = 0;
 
@@ -162,7 +220,7 @@ static unsigned int add_entry( map_entry_t *entry, uint64_t hash,
             ++count;
         }
 
-        map_entry_t *new_entry = malloc( sizeof(map_entry_t) );
+        map_entry_t *new_entry = alloc_entry( map );
         entry->next = new_entry;
         entry = new_entry;
     }
@@ -190,7 +248,7 @@ static void rehash( map_t *map, uint32_t old_size, map_entry_t *new_table )
             while ( entry ) {
                 uint32_t index = (uint32_t)(entry->hash % map->modulo);
                 assert( index < map->allocated );
-                uint32_t collisions = add_entry( &new_table[ index ],
+                uint32_t collisions = add_entry( map, &new_table[ index ],
                                                  entry->hash,
                                                  entry->key, entry->data );
 
@@ -200,7 +258,7 @@ static void rehash( map_t *map, uint32_t old_size, map_entry_t *new_table )
                 // free old collision list
                 map_entry_t *next = entry->next;
                 if ( ! first ) {
-                    free( entry );
+                    free_entry( map, entry );
                 } else {
                     first = false;
                 }
@@ -210,7 +268,8 @@ static void rehash( map_t *map, uint32_t old_size, map_entry_t *new_table )
             }
         }
     }
-    free( map->table );
+    allocator_free( map->allocator, map->table,
+                    sizeof(map_entry_t) * old_size );
     map->table = new_table;
 }
 
@@ -230,7 +289,8 @@ static int make_room( map_t *map )
         }
         uint32_t new_allocated = ( old_size ) ?  2 * old_size : MIN_ALLOCATED;
 
-        map_entry_t *new_table = malloc( sizeof(map_entry_t) * new_allocated );
+        map_entry_t *new_table = allocator_alloc( map->allocator,
+                                        sizeof(map_entry_t) * new_allocated );
         if ( NULL == new_table ) {
             return -1;          // no memory
         }
@@ -243,6 +303,7 @@ static int make_room( map_t *map )
 
         if ( map->table ) {
             rehash ( map, old_size, new_table );
+            ++map->rehashes;
         } else {
             map->table = new_table;
         }
@@ -314,7 +375,8 @@ extern bool map_insert_entry( map_t *map, const void *key, const void *data )
         return false;                           // sorry, no memory
     }
     uint32_t index = hash % map->modulo;    // possibly new index
-    uint32_t collisions = add_entry( &map->table[index], hash, key, data );
+    uint32_t collisions = add_entry( map, &map->table[index],
+                                     hash, key, data );
     if ( map->max_collision < collisions ) {
         map->max_collision = collisions;
     }
@@ -323,6 +385,371 @@ extern bool map_insert_entry( map_t *map, const void *key, const void *data )
     return true;
 }
 
+/* Bulk insertion: entries are first hashed, then partitioned according to
+   their final bucket, each task owning a contiguous range of buckets, so that
+   tasks can fill the table in parallel without any lock. Entries come either
+   from key and value arrays or from the table of another map.
+
+   step 1 (per source chunk):   hash keys and count entries per partition
+   step 2 (sequential):         prefix sums give each chunk/partition offset
+   step 3 (per source chunk):   scatter entries in their partition
+   step 4 (per partition):      insert entries in the partition buckets
+*/
+#define MIN_BULK_TASK_ENTRIES   4096    // don't start a task for less
+#define MAX_BULK_TASKS          64
+
+typedef struct {
+    uint64_t            hash;
+    const void          *key;
+    const void          *data;
+} bulk_entry_t;
+
+typedef struct {
+    map_t               *map;           // destination map
+    const void          **keys;         // source arrays, or
+    const void          **values;
+    const map_entry_t   *table;         // source table
+    uint32_t            size;           // source table allocated size
+    size_t              n;              // number of source entries
+    size_t              ntasks;         // number of tasks
+    conflict_fct        conflict;       // NULL to keep the existing data
+    uint64_t            *hashes;        // n hashes (source arrays only)
+    bulk_entry_t        *entries;       // n partitioned entries
+    size_t              *offsets;       // [chunk][partition] offsets
+    size_t              *starts;        // ntasks + 1 partition starts
+    uint32_t            *inserted;      // per partition
+    uint32_t            *collisions;    // per partition
+    bool                *failed;        // per partition (no memory)
+} bulk_t;
+
+static inline size_t bulk_partition( const map_t *map, uint64_t hash,
+                                     size_t ntasks )
+{
+    uint32_t index = (uint32_t)(hash % map->modulo);
+    return (size_t)(((uint64_t)index * ntasks) / map->modulo);
+}
+
+// source chunks are index ranges in source arrays or in source table
+static inline void bulk_chunk( const bulk_t *bulk, size_t task, size_t ntasks,
+                               size_t *from, size_t *to )
+{
+    parallel_chunk( ( bulk->table ) ? bulk->size : bulk->n, task, ntasks,
+                    from, to );
+}
+
+static void bulk_hash( size_t task, size_t ntasks, void *context )
+{
+    bulk_t *bulk = context;
+    map_t *map = bulk->map;
+    size_t *counts = &bulk->offsets[ task * ntasks ];
+
+    size_t from, to;
+    bulk_chunk( bulk, task, ntasks, &from, &to );
+    if ( bulk->table ) {            // hashes are already in source entries
+        for ( size_t i = from; i < to; ++i ) {
+            const map_entry_t *entry = &bulk->table[i];
+            if ( NULL == entry->key ) continue;
+
+            for ( ; entry != NULL; entry = entry->next ) {
+                ++counts[ bulk_partition( map, entry->hash, ntasks ) ];
+            }
+        }
+        return;
+    }
+    for ( size_t i = from; i < to; ++i ) {
+        const void *key = bulk->keys[i];
+        if ( NULL == key ) continue;    // ignored, and not given to hash_f
+
+        uint64_t hash = (NULL == map->hash_f) ? hash_data( key )
+                                              : map->hash_f( key );
+        bulk->hashes[i] = hash;
+        ++counts[ bulk_partition( map, hash, ntasks ) ];
+    }
+}
+
+static inline void bulk_set( bulk_t *bulk, size_t *offsets, size_t ntasks,
+                             uint64_t hash, const void *key, const void *data )
+{
+    bulk_entry_t *entry =
+        &bulk->entries[ offsets[ bulk_partition( bulk->map, hash, ntasks ) ]++ ];
+    entry->hash = hash;
+    entry->key = key;
+    entry->data = data;
+}
+
+static void bulk_scatter( size_t task, size_t ntasks, void *context )
+{
+    bulk_t *bulk = context;
+    size_t *offsets = &bulk->offsets[ task * ntasks ];
+
+    size_t from, to;
+    bulk_chunk( bulk, task, ntasks, &from, &to );
+    if ( bulk->table ) {
+        for ( size_t i = from; i < to; ++i ) {
+            const map_entry_t *entry = &bulk->table[i];
+            if ( NULL == entry->key ) continue;
+
+            for ( ; entry != NULL; entry = entry->next ) {
+                bulk_set( bulk, offsets, ntasks,
+                          entry->hash, entry->key, entry->data );
+            }
+        }
+        return;
+    }
+    for ( size_t i = from; i < to; ++i ) {
+        if ( NULL == bulk->keys[i] ) continue;
+
+        bulk_set( bulk, offsets, ntasks, bulk->hashes[i], bulk->keys[i],
+                  ( bulk->values ) ? bulk->values[i] : NULL );
+    }
+}
+
+// same as add_entry, except that it does not insert duplicate keys and it
+// checks the collision entry allocation. It returns the number of collisions
+// or -1 if the key is already in the map or -2 if there is no memory. In case
+// of duplicate key, the existing data is replaced by the value returned by
+// the conflict function, if not NULL.
+static int bulk_add_entry( const bulk_t *bulk, map_entry_t *entry,
+                           const bulk_entry_t *bulk_entry )
+{
+    const map_t *map = bulk->map;
+    int count = 0;
+
+    if ( entry->key ) {
+        while ( true ) {
+            if ( entry->hash == bulk_entry->hash &&
+                 ( ( NULL == map->same_f ) ?
+                        entry->key == bulk_entry->key :
+                        map->same_f( entry->key, bulk_entry->key ) ) ) {
+                if ( bulk->conflict ) {
+                    entry->data = bulk->conflict( entry->key, entry->data,
+                                                  bulk_entry->data );
+                }
+                return -1;
+            }
+            ++count;
+            if ( NULL == entry->next ) break;
+            entry = entry->next;
+        }
+
+        map_entry_t *new_entry = alloc_entry( map );
+        if ( NULL == new_entry ) return -2;
+        entry->next = new_entry;
+        entry = new_entry;
+    }
+
+    entry->next = NULL;
+    entry->key  = bulk_entry->key;
+    entry->data = bulk_entry->data;
+    entry->hash = bulk_entry->hash;
+
+    return count;
+}
+
+static void bulk_insert( size_t task, size_t ntasks, void *context )
+{
+    bulk_t *bulk = context;
+    map_t *map = bulk->map;
+    uint32_t inserted = 0, max_collision = 0;
+    bool failed = false;
+
+    for ( size_t i = bulk->starts[task]; i < bulk->starts[task+1]; ++i ) {
+        const bulk_entry_t *entry = &bulk->entries[i];
+        uint32_t index = (uint32_t)(entry->hash % map->modulo);
+        int collisions = bulk_add_entry( bulk, &map->table[index], entry );
+        if ( -2 == collisions ) {
+            failed = true;
+            break;
+        }
+        if ( collisions >= 0 ) {
+            ++inserted;
+            if ( max_collision < (uint32_t)collisions ) {
+                max_collision = (uint32_t)collisions;
+            }
+        }
+    }
+    bulk->inserted[task] = inserted;
+    bulk->collisions[task] = max_collision;
+    bulk->failed[task] = failed;
+}
+
+// allocate all bulk working arrays at once
+static bool bulk_init( bulk_t *bulk, size_t ntasks )
+{
+    const allocator_t *allocator = bulk->map->allocator;
+    bulk->ntasks = ntasks;
+    bulk->hashes = ( bulk->table ) ? NULL
+                        : allocator_alloc( allocator,
+                                           sizeof(uint64_t) * bulk->n );
+    bulk->entries = allocator_alloc( allocator,
+                                     sizeof(bulk_entry_t) * bulk->n );
+    bulk->offsets = allocator_alloc( allocator,
+                                     sizeof(size_t) * ntasks * ntasks );
+    bulk->starts = allocator_alloc( allocator, sizeof(size_t) * (ntasks + 1) );
+    bulk->inserted = allocator_alloc( allocator, sizeof(uint32_t) * ntasks );
+    bulk->collisions = allocator_alloc( allocator, sizeof(uint32_t) * ntasks );
+    bulk->failed = allocator_alloc( allocator, sizeof(bool) * ntasks );
+    if ( NULL != bulk->offsets ) {
+        memset( bulk->offsets, 0, sizeof(size_t) * ntasks * ntasks );
+    }
+
+    return ( NULL != bulk->table || NULL != bulk->hashes ) &&
+           NULL != bulk->entries && NULL != bulk->offsets &&
+           NULL != bulk->starts && NULL != bulk->inserted &&
+           NULL != bulk->collisions && NULL != bulk->failed;
+}
+
+static void bulk_end( bulk_t *bulk )
+{
+    const allocator_t *allocator = bulk->map->allocator;
+    size_t ntasks = bulk->ntasks;
+    allocator_free( allocator, bulk->hashes, sizeof(uint64_t) * bulk->n );
+    allocator_free( allocator, bulk->entries, sizeof(bulk_entry_t) * bulk->n );
+    allocator_free( allocator, bulk->offsets,
+                    sizeof(size_t) * ntasks * ntasks );
+    allocator_free( allocator, bulk->starts, sizeof(size_t) * (ntasks + 1) );
+    allocator_free( allocator, bulk->inserted, sizeof(uint32_t) * ntasks );
+    allocator_free( allocator, bulk->collisions, sizeof(uint32_t) * ntasks );
+    allocator_free( allocator, bulk->failed, sizeof(bool) * ntasks );
+}
+
+// collision entries are allocated by all tasks: only the malloc allocator is
+// assumed to be thread safe, other allocators are used by a single task.
+static size_t bulk_tasks( const map_t *map, size_t n, size_t nthreads )
+{
+    if ( map->allocator != malloc_allocator() ) return 1;
+
+    size_t ntasks = n / MIN_BULK_TASK_ENTRIES;
+    if ( ntasks > nthreads ) ntasks = nthreads;
+    if ( ntasks > MAX_BULK_TASKS ) ntasks = MAX_BULK_TASKS;
+    return ( ntasks ) ? ntasks : 1;
+}
+
+// insert all bulk source entries in the bulk destination map table, which is
+// assumed to be large enough. It returns false in case of failure (no memory)
+static bool bulk_run( bulk_t *bulk, size_t nthreads )
+{
+    if ( 0 == bulk->n ) return true;
+
+    size_t ntasks = bulk_tasks( bulk->map, bulk->n, nthreads );
+    bool failed = true;
+    if ( bulk_init( bulk, ntasks ) ) {
+        parallel_run( bulk_hash, ntasks, bulk );
+        parallel_offsets( bulk->offsets, ntasks, ntasks, bulk->starts );
+        parallel_run( bulk_scatter, ntasks, bulk );
+        parallel_run( bulk_insert, ntasks, bulk );
+
+        map_t *map = bulk->map;
+        failed = false;
+        for ( size_t p = 0; p < ntasks; ++p ) {
+            map->nb += bulk->inserted[p];
+            if ( map->max_collision < bulk->collisions[p] ) {
+                map->max_collision = bulk->collisions[p];
+            }
+            if ( bulk->failed[p] ) failed = true;
+        }
+    }
+    bulk_end( bulk );
+    return ! failed;
+}
+
+// return the table size needed for n entries without triggering make_room
+// or 0 if n entries cannot fit in a map.
+static uint32_t bulk_size( size_t n )
+{
+    if ( n >= 0x60000000 ) return 0;                // 3/4 of 0x80000000
+    return round_up_2power( (uint32_t)(( 4 * (uint64_t)n ) / 3 + 1) );
+}
+
+// do not reallocate the table at the next insertion just because collisions
+// observed during a bulk insertion exceed the minimum.
+static inline void bulk_threshold( map_t *map )
+{
+    if ( map->threshold < map->max_collision ) {
+        map->threshold = map->max_collision;
+    }
+}
+
+extern map_t *new_map_from_arrays( const void **keys, const void **values,
+                                   size_t n, hash_fct hash, same_fct same,
+                                   size_t nthreads )
+{
+    if ( ( 0 != n && NULL == keys ) || ( NULL != hash && NULL == same ) ) {
+        return NULL;
+    }
+    if ( 0 == n ) {
+        return new_map( hash, same, 0, MIN_COLLISIONS );
+    }
+
+    uint32_t size = bulk_size( n );
+    if ( 0 == size ) return NULL;
+
+    map_t *map = new_map( hash, same, size, MIN_COLLISIONS );
+    if ( NULL == map ) return NULL;
+
+    bulk_t bulk = { .map = map, .keys = keys, .values = values, .n = n };
+    if ( ! bulk_run( &bulk, nthreads ) ) {
+        map_free( map );
+        return NULL;
+    }
+    bulk_threshold( map );
+    return map;
+}
+
+// re-allocate the map table with the given size, moving all existing entries
+// in parallel. It returns false in case of failure (no memory), in which case
+// the map is left unchanged.
+static bool bulk_resize( map_t *map, uint32_t size, size_t nthreads )
+{
+    map_entry_t *table = allocator_alloc( map->allocator,
+                                          sizeof(map_entry_t) * size );
+    if ( NULL == table ) return false;
+    memset( (void *)table, 0, sizeof(map_entry_t) * size );
+
+    map_t old = *map;
+    map->table = table;
+    map->allocated = size;
+    map->modulo = get_prime( size );
+    map->max_collision = 0;
+    map->nb = 0;
+
+    bulk_t bulk = { .map = map, .table = old.table,
+                    .size = old.allocated, .n = old.nb };
+    if ( ! bulk_run( &bulk, nthreads ) ) {
+        free_table( map, map->table, map->allocated );
+        *map = old;
+        return false;
+    }
+    if ( old.table ) {
+        free_table( map, old.table, old.allocated );
+        ++map->rehashes;
+    }
+    return true;
+}
+
+extern bool map_merge( map_t *dst, const map_t *src,
+                       conflict_fct conflict, size_t nthreads )
+{
+    if ( NULL == dst || NULL == src || dst == src ||
+         dst->hash_f != src->hash_f || dst->same_f != src->same_f ) {
+        return false;
+    }
+    if ( 0 == src->nb ) return true;
+
+    uint32_t size = bulk_size( (size_t)dst->nb + src->nb );
+    if ( 0 == size ) return false;
+
+    if ( size > dst->allocated && ! bulk_resize( dst, size, nthreads ) ) {
+        return false;
+    }
+
+    bulk_t bulk = { .map = dst, .table = src->table, .size = src->allocated,
+                    .n = src->nb, .conflict = conflict };
+    bool done = bulk_run( &bulk, nthreads );
+    bulk_threshold( dst );
+    return done;
+}
+
 // does not attempt to shrink the hash table
 extern bool map_delete_entry( map_t *map, const void *key )
 {
@@ -341,7 +768,7 @@ extern bool map_delete_entry( map_t *map, const void *key )
     }
     if ( prev ) {
         prev->next = entry->next;
-        free( entry );
+        free_entry( map, entry );
     } else {
         entry->key = entry->data = NULL;
         entry->hash = 0;
@@ -360,7 +787,8 @@ extern slice_t *map_keys( const map_t *map, comp_fct cmp )
 {
     if ( NULL == map ) return NULL;
 
-    slice_t *slice = new_slice( sizeof( void *), map->nb );
+    slice_t *slice = new_slice_with_allocator( sizeof( void *), map->nb,
+                                               map->allocator );
     if ( NULL == slice ) return NULL;
 
     for ( uint32_t i = 0; i < map->allocated; i ++ ) {
@@ -421,3 +849,45 @@ extern void map_stats( const map_t *map )
     printf( "  }\n");
 }
 
+
+extern int map_get_stats( const map_t *map, map_stats_t *stats )
+{
+    if ( NULL == map || NULL == stats ) return -1;
+
+    memset( stats, 0, sizeof(map_stats_t) );
+    stats->entries = map->nb;
+    stats->allocated = map->allocated;
+    stats->buckets = ( map->table ) ? map->modulo : 0;
+    stats->rehashes = map->rehashes;
+
+    // indexes beyond modulo are never used: only sweep usable buckets
+    size_t probes = 0, nodes = 0;
+    for ( uint32_t i = 0; i < stats->buckets; ++i ) {
+        map_entry_t *entry = &map->table[ i ];
+        uint32_t len = 0;
+
+        if ( entry->key ) {
+            for ( ; entry != NULL; entry = entry->next ) {
+                probes += ++len;    // lookup of the len-th entry takes len probes
+            }
+            ++stats->occupied;
+            nodes += len - 1;
+            if ( stats->max_probe < len ) {
+                stats->max_probe = len;
+            }
+        }
+        ++stats->chains[ ( len < MAP_STATS_CHAINS ) ? len
+                                                    : MAP_STATS_CHAINS - 1 ];
+    }
+
+    stats->bytes = sizeof(map_t) +
+                   sizeof(map_entry_t) * ( map->allocated + nodes );
+    if ( stats->buckets ) {
+        stats->load_factor = (double)map->nb / stats->buckets;
+        stats->occupancy = (double)stats->occupied / stats->buckets;
+    }
+    if ( map->nb ) {
+        stats->avg_probe = (double)probes / map->nb;
+    }
+    return 0;
+}
@@ -54,6 +54,63 @@ typedef bool (*same_fct)( const void *key1, const void *key2);
 extern map_t *new_map( hash_fct hash, same_fct same,
                                         uint32_t size, uint32_t collisions );
 
+// same as new_map, but the map, its table and collision entries are allocated
+// with the given allocator (see alloc.h), or with the default allocator if it
+// is NULL. It returns NULL if the allocator has no alloc function or in case
+// of failure (no memory).
+extern map_t *new_map_with_allocator( hash_fct hash, same_fct same,
+                                      uint32_t size, uint32_t collisions,
+                                      const allocator_t *allocator );
+
+// hash and same functions for keys that are pointers to NUL terminated byte
+// strings. The hash is the keyed SipHash-1-3 with a per-process random key
+// (see siphash.h), so that keys coming from external input cannot be crafted
+// to collide in the map table.
+extern uint64_t map_string_hash( const void *key );
+extern bool map_string_same( const void *key1, const void *key2 );
+
+// allocate a new map for NUL terminated byte string keys, using the keyed
+// map_string_hash and map_string_same functions. This is the same as calling
+// new_map( map_string_hash, map_string_same, size, collisions ), and should
+// be used by default when keys are strings from external input.
+extern map_t *new_string_map( uint32_t size, uint32_t collisions );
+
+// allocate a new map and fill it with the n entries given by the arrays keys
+// and values (values may be NULL, in which case all entries have NULL data).
+// The table is allocated once with the exact size required for n entries, key
+// hashes are calculated in parallel and entries are partitioned by bucket
+// range so that nthreads threads can fill the table without locking. If the
+// same key appears multiple times, only the first entry is inserted, and NULL
+// keys are ignored. The hash and same functions must be thread safe. It
+// returns NULL in case of failure (no memory). The library must be linked with
+// -lpthread (see parallel.h).
+extern map_t *new_map_from_arrays( const void **keys, const void **values,
+                                   size_t n, hash_fct hash, same_fct same,
+                                   size_t nthreads );
+
+// conflict function called by map_merge when a key is found in both maps. It
+// returns the data to keep in the destination map for that key, given the
+// destination data dst_data and the source data src_data (e.g. the sum of two
+// counters).
+typedef const void *(*conflict_fct)( const void *key, const void *dst_data,
+                                     const void *src_data );
+
+// merge all src entries into dst, which must have been created with the same
+// hash and same functions. The dst table is re-allocated at most once, to fit
+// all entries from both maps, then disjoint bucket ranges are filled by
+// nthreads threads in parallel. If a key exists in both maps, the dst key is
+// kept and its data is replaced by the value returned by the conflict function
+// or left unchanged if conflict is NULL. The conflict function may be called
+// concurrently for different keys, and like hash and same functions it must
+// be thread safe. Collision entries are allocated by all threads, unless dst
+// was created with an allocator other than malloc, in which case the merge is
+// done by the calling thread only. The src map is not modified. It returns
+// true in case of success, false if the maps are not compatible or in case of
+// failure (no memory), in which case dst may have received only part of src
+// entries.
+extern bool map_merge( map_t *dst, const map_t *src,
+                       conflict_fct conflict, size_t nthreads );
+
 // free an existing map. If needed, keys and data must be freed separately (see
 // map_process).
 extern int map_free(map_t *map );
@@ -90,11 +147,37 @@ extern void map_process_entries( const map_t *map,
 // return a slice with all keys in the map, or NULL in case of failure. If the
 // argument cmp is not NULL, keys are sorted otherwise keys are NOT stored in
 // any particular order. Keys in the slice are just the void * that were
-// provided in map_insert_entry. After use the returned slice must be freed by
-// calling slice_free.
+// provided in map_insert_entry. The slice is allocated with the map allocator.
+// After use the returned slice must be freed by calling slice_free.
 extern slice_t *map_keys( const map_t *map, comp_fct cmp );
 
 // stats for checking usage and collisions
 extern void map_stats( const map_t *map );
 
+// number of classes in the map_stats_t chain length histogram. The class at
+// index i counts buckets holding exactly i entries (index 0 counts the empty
+// buckets), except the last class that counts all buckets holding at least
+// MAP_STATS_CHAINS - 1 entries.
+#define MAP_STATS_CHAINS    16
+
+typedef struct {
+    size_t      entries;        // current number of entries in map
+    size_t      bytes;          // memory allocated for map, table and nodes
+    uint32_t    allocated;      // number of allocated table slots
+    uint32_t    buckets;        // number of usable table slots (hash modulo)
+    uint32_t    occupied;       // number of non-empty buckets
+    uint32_t    max_probe;      // longest chain, i.e. worst lookup probes
+    uint32_t    rehashes;       // number of table re-allocations so far
+    double      load_factor;    // entries / buckets
+    double      occupancy;      // occupied / buckets
+    double      avg_probe;      // average probes for a successful lookup
+    uint32_t    chains[MAP_STATS_CHAINS];   // chain length histogram
+} map_stats_t;
+
+// fill the stats structure with the current map usage, without printing
+// anything. It sweeps the table once without allocating memory, so that it
+// can be called periodically on large maps. It returns 0 in case of success
+// or -1 if any argument is NULL.
+extern int map_get_stats( const map_t *map, map_stats_t *stats );
+
 #endif /* __MAP_H__ */
@@ -0,0 +1,81 @@
+
+#include <stdlib.h>
+#include <pthread.h>
+
+#include "parallel.h"
+
+typedef struct {
+    pthread_t   thread;
+    task_fct    fct;
+    size_t      task;
+    size_t      ntasks;
+    void        *context;
+    int         started;        // 0 if the thread could not be created
+} task_t;
+
+static void *run_task( void *arg )
+{
+    task_t *task = arg;
+    task->fct( task->task, task->ntasks, task->context );
+    return NULL;
+}
+
+extern void parallel_run( task_fct fct, size_t ntasks, void *context )
+{
+    if ( NULL == fct ) return;
+
+    if ( ntasks <= 1 ) {
+        fct( 0, 1, context );
+        return;
+    }
+
+    task_t *tasks = malloc( sizeof(task_t) * ntasks );
+    if ( NULL == tasks ) {          // run all tasks in sequence
+        for ( size_t i = 0; i < ntasks; ++i ) {
+            fct( i, ntasks, context );
+        }
+        return;
+    }
+
+    for ( size_t i = 1; i < ntasks; ++i ) {
+        tasks[i].fct = fct;
+        tasks[i].task = i;
+        tasks[i].ntasks = ntasks;
+        tasks[i].context = context;
+        tasks[i].started = ( 0 == pthread_create( &tasks[i].thread, NULL,
+                                                  run_task, &tasks[i] ) );
+    }
+
+    fct( 0, ntasks, context );      // calling thread is task 0
+
+    for ( size_t i = 1; i < ntasks; ++i ) {
+        if ( tasks[i].started ) {
+            pthread_join( tasks[i].thread, NULL );
+        } else {
+            fct( i, ntasks, context );
+        }
+    }
+    free( tasks );
+}
+
+extern void parallel_chunk( size_t n, size_t task, size_t ntasks,
+                            size_t *from, size_t *to )
+{
+    *from = (n * task) / ntasks;
+    *to = (n * (task + 1)) / ntasks;
+}
+
+extern void parallel_offsets( size_t *counts, size_t nchunks, size_t nparts,
+                              size_t *starts )
+{
+    size_t offset = 0;
+    for ( size_t part = 0; part < nparts; ++part ) {
+        starts[part] = offset;
+        for ( size_t c = 0; c < nchunks; ++c ) {
+            size_t count = counts[ c * nparts + part ];
+            counts[ c * nparts + part ] = offset;
+            offset += count;
+        }
+    }
+    starts[nparts] = offset;
+}
@@ -0,0 +1,44 @@
+
+#ifndef __PARALLEL_H__
+#define __PARALLEL_H__
+
+#include <stddef.h>
+
+/*
+    Minimal fork-join helper used by the bulk operations of the library.
+
+    A job is split in a number of tasks, each running the same function with
+    a different task rank. All tasks are started at once, and parallel_run
+    returns only when all of them are done, so that a job made of several
+    dependent steps is simply a sequence of parallel_run calls.
+
+    The first task is always run by the calling thread. If a thread cannot be
+    created, the corresponding task is run by the calling thread as well, so
+    that a job always completes, even if it is not done in parallel.
+
+    The library must be linked with -lpthread.
+*/
+
+// function run by each task. The argument task is the task rank, from 0 to
+// ntasks - 1, and context is the parallel_run caller context, shared by all
+// tasks.
+typedef void (*task_fct)( size_t task, size_t ntasks, void *context );
+
+// run ntasks tasks in parallel and wait for all of them to finish. If ntasks
+// is 0 or 1 fct is just called once by the calling thread.
+extern void parallel_run( task_fct fct, size_t ntasks, void *context );
+
+// split n items in ntasks ranges of nearly equal sizes, and return the range
+// [*from, *to[ of the given task.
+extern void parallel_chunk( size_t n, size_t task, size_t ntasks,
+                            size_t *from, size_t *to );
+
+// turn counts[chunk * nparts + part], the number of items that each of
+// nchunks chunks gives to each of nparts partitions, into offsets where all
+// chunks for the same partition follow each other, so that chunks can then
+// scatter their items in parallel without synchronization. The nparts + 1
+// starts receive the start of each partition, followed by the total count.
+extern void parallel_offsets( size_t *counts, size_t nchunks, size_t nparts,
+                              size_t *starts );
+
+#endif /* __PARALLEL_H__ */
@@ -0,0 +1,147 @@
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "slice.h"
+#include "_slice.h"
+#include "partition.h"
+#include "_partition.h"
+#include "parallel.h"
+
+#define MAX_PARTITION_BITS          16
+#define MIN_PARTITION_TASK_ROWS     4096    // don't start a task for less
+#define MAX_PARTITION_TASKS         64
+
+typedef struct {
+    partition_t     *partition;
+    const slice_t   *slice;
+    row_key_fct     key;
+    hash_fct        hash;
+    size_t          n;
+    size_t          nparts;
+    partition_row_t *rows;          // n rows with key and hash, in order
+    size_t          *offsets;       // [chunk][partition] offsets
+} partitioning_t;
+
+static void count_rows( size_t task, size_t ntasks, void *context )
+{
+    partitioning_t *p = context;
+    size_t *counts = &p->offsets[ task * p->nparts ];
+    uint32_t bits = p->partition->bits;
+
+    size_t from, to;
+    parallel_chunk( p->n, task, ntasks, &from, &to );
+    for ( size_t i = from; i < to; ++i ) {
+        const void *key = p->key( _slice_item_at( p->slice, i ) );
+        uint64_t hash = ( p->hash ) ? p->hash( key ) : (uint64_t)key;
+        partition_row_t *row = &p->rows[i];
+        row->hash = hash;
+        row->key = key;
+        row->row = i;
+        ++counts[ _partition_index( hash, bits ) ];
+    }
+}
+
+static void scatter_rows( size_t task, size_t ntasks, void *context )
+{
+    partitioning_t *p = context;
+    size_t *offsets = &p->offsets[ task * p->nparts ];
+    uint32_t bits = p->partition->bits;
+
+    size_t from, to;
+    parallel_chunk( p->n, task, ntasks, &from, &to );
+    for ( size_t i = from; i < to; ++i ) {      // key and hash of count_rows
+        const partition_row_t *row = &p->rows[i];
+        size_t index = _partition_index( row->hash, bits );
+        p->partition->rows[ offsets[index]++ ] = *row;
+    }
+}
+
+extern uint32_t partition_bits( size_t n, size_t rows_per_partition )
+{
+    if ( 0 == rows_per_partition ) rows_per_partition = 1;
+
+    uint32_t bits = 0;
+    while ( bits < MAX_PARTITION_BITS && ( n >> bits ) > rows_per_partition ) {
+        ++bits;
+    }
+    return bits;
+}
+
+extern partition_t *new_partition( const slice_t *slice, row_key_fct key,
+                                   hash_fct hash, uint32_t bits,
+                                   size_t nthreads )
+{
+    if ( NULL == slice || NULL == key || bits > MAX_PARTITION_BITS ) {
+        return NULL;
+    }
+
+    partition_t *partition = malloc( sizeof(partition_t) );
+    if ( NULL == partition ) return NULL;
+
+    size_t n = _slice_len( slice );
+    size_t nparts = (size_t)1 << bits;
+    size_t ntasks = n / MIN_PARTITION_TASK_ROWS;
+    if ( ntasks > nthreads ) ntasks = nthreads;
+    if ( ntasks > MAX_PARTITION_TASKS ) ntasks = MAX_PARTITION_TASKS;
+    if ( 0 == ntasks ) ntasks = 1;
+
+    partitioning_t p = { .partition = partition, .slice = slice, .key = key,
+                         .hash = hash, .n = n, .nparts = nparts };
+    partition->bits = bits;
+    partition->rows = malloc( sizeof(partition_row_t) * ( n ? n : 1 ) );
+    partition->starts = malloc( sizeof(size_t) * ( nparts + 1 ) );
+    p.rows = malloc( sizeof(partition_row_t) * ( n ? n : 1 ) );
+    p.offsets = calloc( ntasks * nparts, sizeof(size_t) );
+
+    if ( NULL == partition->rows || NULL == partition->starts ||
+         NULL == p.rows || NULL == p.offsets ) {
+        free( p.rows );
+        free( p.offsets );
+        partition_free( partition );
+        return NULL;
+    }
+
+    parallel_run( count_rows, ntasks, &p );
+    parallel_offsets( p.offsets, ntasks, nparts, partition->starts );
+    parallel_run( scatter_rows, ntasks, &p );
+
+    free( p.rows );
+    free( p.offsets );
+    return partition;
+}
+
+extern size_t partition_count( const partition_t *partition )
+{
+    if ( NULL == partition ) return 0;
+    return _partition_count( partition );
+}
+
+extern uint32_t partition_get_bits( const partition_t *partition )
+{
+    if ( NULL == partition ) return 0;
+    return partition->bits;
+}
+
+extern const partition_row_t *partition_rows( const partition_t *partition,
+                                              size_t index, size_t *lenp )
+{
+    size_t len = 0;
+    const partition_row_t *rows = NULL;
+
+    if ( NULL != partition && index < _partition_count( partition ) ) {
+        rows = _partition_rows( partition, index, &len );
+    }
+    if ( lenp ) { *lenp = len; }
+    return ( len ) ? rows : NULL;
+}
+
+extern void partition_free( partition_t *partition )
+{
+    if ( NULL == partition ) return;
+
+    free( partition->rows );
+    free( partition->starts );
+    free( partition );
+}
@@ -0,0 +1,71 @@
+
+#ifndef __PARTITION_H__
+#define __PARTITION_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "slice.h"
+#include "map.h"
+
+/*
+    Radix partitioning of slice items (rows) by key hash.
+
+    Each row of a slice is given a key by a user function, the key is hashed
+    and rows are distributed in 2^bits partitions according to the top bits of
+    the (mixed) hash value, so that rows with the same key always end up in the
+    same partition. Rows are copied in partition order as partition_row_t
+    entries, giving the key, the original hash and the row index in the slice.
+
+    The partition is selected by the top bits of the hash value multiplied by
+    2^64 divided by the golden ratio, so that the following bits of the same
+    product can be used to index the partition rows in a small hash table (see
+    _partition.h).
+
+    Partitioning is done in two passes over the slice (counting, then
+    scattering), each pass being split in chunks processed in parallel by
+    multiple threads (see parallel.h).
+
+    As for maps, if the hash function is NULL the hash value of a key is just
+    its pointer cast as uint64_t.
+*/
+
+typedef struct partition partition_t;
+
+// return the key of a row, given a pointer to the row item in the slice.
+typedef const void *(*row_key_fct)( const void *row );
+
+typedef struct {
+    uint64_t    hash;           // key hash
+    const void  *key;           // row key
+    size_t      row;            // row index in the partitioned slice
+} partition_row_t;
+
+// return the smallest number of partition bits so that partitions hold on
+// average at most rows_per_partition rows, given n rows in total.
+extern uint32_t partition_bits( size_t n, size_t rows_per_partition );
+
+// partition all rows in slice according to their key hash, in 2^bits
+// partitions (bits is at most 16), using nthreads threads. The key and hash
+// functions must be thread safe. It returns NULL in case of failure (no
+// memory or bad arguments).
+extern partition_t *new_partition( const slice_t *slice, row_key_fct key,
+                                   hash_fct hash, uint32_t bits,
+                                   size_t nthreads );
+
+// return the number of partitions (2^bits).
+extern size_t partition_count( const partition_t *partition );
+
+// return the number of bits used to select partitions.
+extern uint32_t partition_get_bits( const partition_t *partition );
+
+// return a pointer to the first row of the partition index and set *lenp to
+// the number of rows in that partition. It returns NULL if the index is out
+// of range or if the partition is empty.
+extern const partition_row_t *partition_rows( const partition_t *partition,
+                                              size_t index, size_t *lenp );
+
+// free a partition. It does not modify the partitioned slice.
+extern void partition_free( partition_t *partition );
+
+#endif /* __PARTITION_H__ */
@@ -4,12 +4,15 @@
 #include <assert.h>
 
 #include "queue.h"
+#include "slab.h"
 
 struct _queue {
     struct _dllentry    *head;
     struct _dllentry    *tail;
     node_free_fct       node_free;
     size_t              size;
+    const allocator_t   *allocator; // for the queue and its entries
+    slab_t              *entries;   // entry cache with the malloc allocator
 };
 
 typedef struct _dllentry {
@@ -18,9 +21,38 @@ typedef struct _dllentry {
     void                *node;
 } dllentry;
 
+static inline dllentry *alloc_entry( queue_t *q )
+{
+    if ( q->entries ) return slab_alloc( q->entries );
+    return allocator_alloc( q->allocator, sizeof( dllentry ) );
+}
+
+static inline void free_entry( queue_t *q, dllentry *entry )
+{
+    if ( q->entries ) {
+        slab_release( q->entries, entry );
+    } else {
+        allocator_free( q->allocator, entry, sizeof( dllentry ) );
+    }
+}
+
 extern queue_t *new_queue( node_free_fct node_free )
 {
-    queue_t *q = malloc( sizeof( queue_t ) );
+    return new_queue_with_allocator( node_free, NULL );
+}
+
+extern queue_t *new_queue_with_allocator( node_free_fct node_free,
+                                          const allocator_t *allocator )
+{
+    if ( NULL == allocator ) allocator = default_allocator( );
+    if ( NULL == allocator->alloc ) return NULL;
+
+    queue_t *q = allocator_alloc( allocator, sizeof( queue_t ) );
+    if ( NULL == q ) return NULL;
+
+    q->allocator = allocator;
+    q->entries = ( allocator == malloc_allocator( ) ) ?
+                        shared_slab( sizeof( dllentry ) ) : NULL;
     q->head = q->tail = NULL;
     q->size = 0;
     if ( node_free ) {
@@ -42,17 +74,17 @@ extern void queue_free( queue_t *q, bool free_nodes )
         }
         next = entry->next;
         entry->next = entry->prev = entry->node = NULL;
-        free( entry );
+        free_entry( q, entry );
     }
     q->head = q->tail = NULL;
-    free( q );
+    allocator_free( q->allocator, q, sizeof( queue_t ) );
 }
 
 extern int queue_head_insert( queue_t *q, void *node )
 {
     if ( NULL == q || NULL == node ) return -1;
 
-    dllentry *entry = malloc( sizeof( dllentry ) );
+    dllentry *entry = alloc_entry( q );
     if ( NULL == entry ) return -1;
 
     entry->node = node;
@@ -74,7 +106,7 @@ extern int queue_tail_append( queue_t *q, void *node )
 {
     if ( NULL == q || NULL == node ) return -1;
 
-    dllentry *entry = malloc( sizeof( dllentry ) );
+    dllentry *entry = alloc_entry( q );
     if ( NULL == entry ) return -1;
 
     entry->node = node;
@@ -122,7 +154,7 @@ extern void *queue_head_extract( queue_t *q )
         q->tail = NULL;
     }
     void *node = head->node;
-    free( head );
+    free_entry( q, head );
 
     --q->size;
     return node;
@@ -140,7 +172,7 @@ extern void *queue_tail_extract( queue_t *q )
         q->head = NULL;
     }
     void *node = tail->node;
-    free( tail );
+    free_entry( q, tail );
 
     --q->size;
     return node;
@@ -6,6 +6,7 @@
 #include <stdbool.h>
 
 #include "node.h"
+#include "alloc.h"
 
 /*
     Simple queue for fifo, lifo or mixed usage based on a double linked list
@@ -19,6 +20,12 @@ typedef struct _queue queue_t;
 // is NULL, nodes are deleted by calling free.
 extern queue_t *new_queue( node_free_fct free_node );
 
+// same as new_queue, but the queue and its list entries are allocated with the
+// given allocator (see alloc.h), or with the default allocator if it is NULL.
+// Nodes are not allocated by the queue and are still freed by free_node.
+extern queue_t *new_queue_with_allocator( node_free_fct free_node,
+                                          const allocator_t *allocator );
+
 // delete a queue and free all nodes still in queue depending on the argument
 // free_nodes.
 extern void queue_free( queue_t *q, bool free_nodes );
@@ -0,0 +1,294 @@
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <math.h>
+
+#include "slice.h"
+#include "_slice.h"
+#include "ring.h"
+#include "xxh64.h"
+
+#define MAX_JUMP_BITS       24
+
+typedef struct {
+    uint64_t    hash;           // position on the circle
+    uint32_t    node;           // node identifier
+    uint32_t    slot;           // node index in nodes
+} ring_point_t;
+
+typedef struct {
+    uint32_t    node;
+    size_t      load;           // keys assigned and not released
+} ring_node_t;
+
+struct ring {
+    slice_t         *nodes;     // ring_node_t, in order of addition
+    slice_t         *points;    // ring_point_t, sorted by hash
+    const ring_point_t *data;   // points data, cached for lookups
+    size_t          npoints;
+    uint32_t        *jump;      // first point index for each top bits value
+    uint32_t        jump_bits;
+    uint32_t        vnodes;
+    double          load_factor;
+    size_t          assigned;   // sum of all node loads
+};
+
+static int compare_points( const void *item1, const void *item2 )
+{
+    const ring_point_t *p1 = item1, *p2 = item2;
+    if ( p1->hash != p2->hash ) return ( p1->hash < p2->hash ) ? -1 : 1;
+    return ( p1->node < p2->node ) ? -1 : ( p1->node > p2->node );
+}
+
+// point position of a node replica, independent of the host byte order
+static uint64_t point_hash( uint32_t node, uint32_t replica )
+{
+    uint8_t buffer[8];
+    for ( int i = 0; i < 4; ++i ) {
+        buffer[i] = (uint8_t)( node >> ( 8 * i ) );
+        buffer[4 + i] = (uint8_t)( replica >> ( 8 * i ) );
+    }
+    return xxh64( buffer, 8 );
+}
+
+static uint32_t jump_bits( size_t npoints )
+{
+    uint32_t bits = 1;
+    while ( bits < MAX_JUMP_BITS && ( (size_t)2 << bits ) <= npoints ) ++bits;
+    return bits;
+}
+
+// rebuild all points and the jump table from the current nodes. In case of
+// failure (no memory), the ring is left unchanged and it returns false.
+static bool rebuild( ring_t *ring )
+{
+    size_t nnodes = _slice_len( ring->nodes );
+    size_t npoints = nnodes * ring->vnodes;
+
+    slice_t *points = new_slice( sizeof(ring_point_t), npoints ? npoints : 1 );
+    if ( NULL == points ) return false;
+
+    uint32_t bits = jump_bits( npoints );
+    uint32_t *jump = malloc( sizeof(uint32_t) * ( ( (size_t)1 << bits ) + 1 ) );
+    if ( NULL == jump ) {
+        slice_free( points );
+        return false;
+    }
+
+    for ( size_t slot = 0; slot < nnodes; ++slot ) {
+        const ring_node_t *node = _slice_item_at( ring->nodes, slot );
+        for ( uint32_t r = 0; r < ring->vnodes; ++r ) {
+            ring_point_t point = { point_hash( node->node, r ),
+                                   node->node, (uint32_t)slot };
+            _slice_append_item( points, &point );
+        }
+    }
+    if ( npoints ) {
+        slice_sort_items( points, compare_points );
+    }
+
+    // jump[i] is the index of the first point whose top bits are at least i
+    const ring_point_t *data = (const ring_point_t *)
+                                        _slice_data_n_len( points, NULL );
+    size_t index = 0;
+    for ( size_t i = 0; i <= ( (size_t)1 << bits ); ++i ) {
+        while ( index < npoints && ( data[index].hash >> ( 64 - bits ) ) < i )
+            ++index;
+        jump[i] = (uint32_t)index;
+    }
+
+    slice_free( ring->points );
+    free( ring->jump );
+    ring->points = points;
+    ring->data = data;
+    ring->npoints = npoints;
+    ring->jump = jump;
+    ring->jump_bits = bits;
+    return true;
+}
+
+extern ring_t *new_ring( uint32_t vnodes, double load_factor )
+{
+    if ( 0 == vnodes || vnodes > ( UINT32_MAX >> 8 ) ||
+         ( 0.0 != load_factor && ! ( load_factor > 1.0 ) ) )
+        return NULL;
+
+    ring_t *ring = malloc( sizeof(ring_t) );
+    if ( NULL == ring ) return NULL;
+
+    ring->nodes = new_slice( sizeof(ring_node_t), 8 );
+    ring->points = NULL;
+    ring->jump = NULL;
+    ring->vnodes = vnodes;
+    ring->load_factor = load_factor;
+    ring->assigned = 0;
+    if ( NULL == ring->nodes || ! rebuild( ring ) ) {
+        slice_free( ring->nodes );
+        free( ring );
+        return NULL;
+    }
+    return ring;
+}
+
+extern int ring_free( ring_t *ring )
+{
+    if ( NULL == ring ) return -1;
+    slice_free( ring->nodes );
+    slice_free( ring->points );
+    free( ring->jump );
+    free( ring );
+    return 0;
+}
+
+static ring_node_t *find_node( const ring_t *ring, uint32_t node,
+                               size_t *slotp )
+{
+    size_t nnodes = _slice_len( ring->nodes );
+    for ( size_t slot = 0; slot < nnodes; ++slot ) {
+        ring_node_t *item = _slice_item_at( ring->nodes, slot );
+        if ( node == item->node ) {
+            if ( slotp ) *slotp = slot;
+            return item;
+        }
+    }
+    return NULL;
+}
+
+extern bool ring_add_node( ring_t *ring, uint32_t node )
+{
+    if ( NULL == ring || RING_NO_NODE == node ||
+         NULL != find_node( ring, node, NULL ) ||
+         ( _slice_len( ring->nodes ) + 1 ) * ring->vnodes > UINT32_MAX )
+        return false;
+
+    ring_node_t item = { node, 0 };
+    if ( 0 != slice_append_item( ring->nodes, &item ) ) return false;
+
+    if ( ! rebuild( ring ) ) {
+        slice_update_len( ring->nodes, _slice_len( ring->nodes ) - 1 );
+        return false;
+    }
+    return true;
+}
+
+extern bool ring_remove_node( ring_t *ring, uint32_t node )
+{
+    size_t slot;
+    if ( NULL == ring ) return false;
+
+    ring_node_t *found = find_node( ring, node, &slot );
+    if ( NULL == found ) return false;
+
+    // the node order does not matter: replace the node with the last one
+    size_t last = _slice_len( ring->nodes ) - 1;
+    ring_node_t item = *found;
+    *found = *(ring_node_t *)_slice_item_at( ring->nodes, last );
+    _slice_update_len( ring->nodes, last );
+
+    if ( ! rebuild( ring ) ) {
+        _slice_update_len( ring->nodes, last + 1 );
+        *(ring_node_t *)_slice_item_at( ring->nodes, last ) = *found;
+        *found = item;
+        return false;
+    }
+    ring->assigned -= item.load;
+    return true;
+}
+
+extern size_t ring_nodes( const ring_t *ring )
+{
+    if ( NULL == ring ) return 0;
+    return _slice_len( ring->nodes );
+}
+
+// index of the first point at or after hash, wrapping around at the end. The
+// jump table gives the range of points with the same top bits as hash, which
+// is binary searched. If all points in that range are before hash, the next
+// point is the first one of the following ranges.
+static inline size_t point_index( const ring_t *ring, uint64_t hash )
+{
+    size_t top = (size_t)( hash >> ( 64 - ring->jump_bits ) );
+    size_t low = ring->jump[top], high = ring->jump[top + 1];
+
+    while ( low < high ) {
+        size_t mid = low + ( high - low ) / 2;
+        if ( ring->data[mid].hash < hash ) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return ( low == ring->npoints ) ? 0 : low;
+}
+
+extern uint32_t ring_lookup_hash( const ring_t *ring, uint64_t hash )
+{
+    if ( NULL == ring || 0 == ring->npoints ) return RING_NO_NODE;
+    return ring->data[ point_index( ring, hash ) ].node;
+}
+
+extern uint32_t ring_lookup( const ring_t *ring, uint8_t *data, size_t len )
+{
+    if ( NULL == ring || NULL == data ) return RING_NO_NODE;
+    return ring_lookup_hash( ring, xxh64( data, len ) );
+}
+
+extern uint32_t ring_assign( ring_t *ring, uint64_t hash )
+{
+    if ( NULL == ring || 0 == ring->npoints || 0.0 == ring->load_factor )
+        return RING_NO_NODE;
+
+    size_t nnodes = _slice_len( ring->nodes );
+    double capacity = ceil( ring->load_factor * (double)( ring->assigned + 1 )
+                            / (double)nnodes );
+
+    // since load_factor > 1, at least one node is below capacity
+    size_t index = point_index( ring, hash );
+    for ( size_t i = 0; i < ring->npoints; ++i ) {
+        ring_node_t *node = _slice_item_at( ring->nodes,
+                                            ring->data[index].slot );
+        if ( (double)node->load < capacity ) {
+            ++node->load;
+            ++ring->assigned;
+            return node->node;
+        }
+        if ( ++index == ring->npoints ) index = 0;
+    }
+    return RING_NO_NODE;
+}
+
+extern bool ring_release( ring_t *ring, uint32_t node )
+{
+    if ( NULL == ring ) return false;
+
+    ring_node_t *found = find_node( ring, node, NULL );
+    if ( NULL == found || 0 == found->load ) return false;
+
+    --found->load;
+    --ring->assigned;
+    return true;
+}
+
+extern size_t ring_load( const ring_t *ring, uint32_t node )
+{
+    if ( NULL == ring ) return 0;
+
+    const ring_node_t *found = find_node( ring, node, NULL );
+    return ( found ) ? found->load : 0;
+}
+
+extern int32_t jump_consistent_hash( uint64_t key, int32_t buckets )
+{
+    if ( buckets <= 0 ) return -1;
+
+    int64_t b = -1, j = 0;
+    while ( j < buckets ) {
+        b = j;
+        key = key * 2862933555777941757ULL + 1;
+        j = (int64_t)( (double)( b + 1 ) *
+                       ( (double)( (int64_t)1 << 31 ) /
+                         (double)( ( key >> 33 ) + 1 ) ) );
+    }
+    return (int32_t)b;
+}
@@ -0,0 +1,98 @@
+
+#ifndef __RING_H__
+#define __RING_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/*
+    Consistent hashing
+
+    Distributing keys over N nodes with hash % N moves almost all keys to a
+    different node when N changes. With consistent hashing, only about 1/N of
+    the keys move when a node is added or removed.
+
+    A ring places vnodes virtual nodes (points) per node on a 64-bit hash
+    circle. A key belongs to the node owning the first point at or after the
+    key hash, wrapping around at the end of the circle. Points are kept sorted
+    in a slice_t, and a jump table indexed by the top bits of the key hash
+    gives the small range of points to search, so that a lookup is one table
+    access and a binary search over a few points.
+
+    Node identifiers are any uint32_t values except RING_NO_NODE, and point
+    positions only depend on node identifiers, so that rings built with the
+    same nodes in any order are identical. Keys are hashed with xxh64 (see
+    xxh64.h), or the _hash functions take a 64-bit hash value calculated by
+    the caller.
+
+    Optionally, lookups can be bounded-load: ring_assign gives a key to the
+    first node after the key hash whose current load is below the capacity
+    load_factor * (assigned keys + 1) / nodes, so that no node gets more than
+    load_factor times the average load, while still moving few keys when
+    nodes change. Loads are tracked per node by ring_assign and ring_release.
+
+    A ring can be looked up concurrently by multiple threads, as long as it is
+    not modified at the same time (ring_add_node, ring_remove_node, ring_assign
+    and ring_release modify the ring).
+
+    jump_consistent_hash is a stateless alternative when nodes are numbered
+    from 0 to N - 1 and only the last node can be removed.
+
+    Bounded loads use the math library: the program must be linked with -lm.
+*/
+
+typedef struct ring ring_t;
+
+// node identifier returned when a ring has no node
+#define RING_NO_NODE        UINT32_MAX
+
+// allocate a new empty ring with vnodes points per node (a few hundreds give
+// a good balance between nodes). The load_factor is used for bounded-load
+// assignment (ring_assign), and must be greater than 1 (e.g. 1.25), or 0 if
+// ring_assign is not used. It returns NULL in case of wrong arguments or
+// failure (no memory).
+extern ring_t *new_ring( uint32_t vnodes, double load_factor );
+
+// free an existing ring.
+extern int ring_free( ring_t *ring );
+
+// add a node to the ring. It returns false if the node is already in the ring,
+// if node is RING_NO_NODE or in case of failure (no memory).
+extern bool ring_add_node( ring_t *ring, uint32_t node );
+
+// remove a node from the ring. It returns false if the node is not in the ring
+// or in case of failure (no memory). Keys assigned to the node by ring_assign
+// are not reassigned: they must be assigned again by the caller.
+extern bool ring_remove_node( ring_t *ring, uint32_t node );
+
+// return the number of nodes in the ring
+extern size_t ring_nodes( const ring_t *ring );
+
+// return the node owning a key given by its data and length, or by its 64-bit
+// hash value, or RING_NO_NODE if the ring is empty.
+extern uint32_t ring_lookup( const ring_t *ring, uint8_t *data, size_t len );
+extern uint32_t ring_lookup_hash( const ring_t *ring, uint64_t hash );
+
+// assign a key given by its 64-bit hash value to a node, with bounded load,
+// and increment the node load. It returns the node or RING_NO_NODE if the ring
+// is empty or was created with a load_factor of 0.
+extern uint32_t ring_assign( ring_t *ring, uint64_t hash );
+
+// decrement the load of a node, after a key assigned by ring_assign has been
+// removed. It returns false if the node is not in the ring or has no load.
+extern bool ring_release( ring_t *ring, uint32_t node );
+
+// return the current load of a node (number of keys assigned by ring_assign
+// and not released), or 0 if the node is not in the ring.
+extern size_t ring_load( const ring_t *ring, uint32_t node );
+
+// return the bucket in [0, buckets[ for a key, using the jump consistent hash
+// by John Lamping and Eric Veach (https://arxiv.org/abs/1406.2294): when the
+// number of buckets grows from N to N + 1, only 1 / (N + 1) of the keys move,
+// all to the new bucket. It takes no memory, but buckets are numbered in
+// sequence and only the last one can be removed. It returns -1 if buckets is
+// not positive.
+extern int32_t jump_consistent_hash( uint64_t key, int32_t buckets );
+
+#endif /* __RING_H__ */
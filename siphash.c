@@ -0,0 +1,111 @@
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+
+#include "siphash.h"
+
+#define SIP_C_ROUNDS    1
+#define SIP_D_ROUNDS    3
+
+static inline uint64_t rotl64( uint64_t x, int r )
+{
+    return ( x << r ) | ( x >> (64 - r) );
+}
+
+static inline uint64_t read64( const uint8_t *data )
+{
+    uint64_t word;
+    memcpy( &word, data, 8 );
+#if defined( __BYTE_ORDER__ ) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    word = __builtin_bswap64( word );
+#endif
+    return word;
+}
+
+#define SIP_ROUND( v0, v1, v2, v3 )                                         \
+    do {                                                                    \
+        v0 += v1; v1 = rotl64( v1, 13 ); v1 ^= v0; v0 = rotl64( v0, 32 );   \
+        v2 += v3; v3 = rotl64( v3, 16 ); v3 ^= v2;                          \
+        v0 += v3; v3 = rotl64( v3, 21 ); v3 ^= v0;                          \
+        v2 += v1; v1 = rotl64( v1, 17 ); v1 ^= v2; v2 = rotl64( v2, 32 );   \
+    } while ( 0 )
+
+static inline uint64_t _siphash13( uint64_t k0, uint64_t k1,
+                                   const uint8_t *data, size_t len )
+{
+    // initial state is "somepseudorandomlygeneratedbytes" xored with key
+    uint64_t v0 = k0 ^ 0x736f6d6570736575;
+    uint64_t v1 = k1 ^ 0x646f72616e646f6d;
+    uint64_t v2 = k0 ^ 0x6c7967656e657261;
+    uint64_t v3 = k1 ^ 0x7465646279746573;
+
+    const uint8_t *end = data + ( len & ~(size_t)7 );
+    for ( ; data < end; data += 8 ) {
+        uint64_t m = read64( data );
+        v3 ^= m;
+        for ( int i = 0; i < SIP_C_ROUNDS; ++i ) {
+            SIP_ROUND( v0, v1, v2, v3 );
+        }
+        v0 ^= m;
+    }
+
+    uint64_t last = (uint64_t)len << 56;        // length and last bytes
+    for ( size_t i = 0; i < ( len & 7 ); ++i ) {
+        last |= (uint64_t)data[i] << ( 8 * i );
+    }
+    v3 ^= last;
+    for ( int i = 0; i < SIP_C_ROUNDS; ++i ) {
+        SIP_ROUND( v0, v1, v2, v3 );
+    }
+    v0 ^= last;
+
+    v2 ^= 0xff;
+    for ( int i = 0; i < SIP_D_ROUNDS; ++i ) {
+        SIP_ROUND( v0, v1, v2, v3 );
+    }
+    return v0 ^ v1 ^ v2 ^ v3;
+}
+
+uint64_t siphash13( const uint8_t key[16], uint8_t *data, size_t len )
+{
+    return _siphash13( read64( key ), read64( key + 8 ), data, len );
+}
+
+static uint64_t process_k0, process_k1;
+static pthread_once_t process_key_once = PTHREAD_ONCE_INIT;
+
+static void init_process_key( void )
+{
+    uint8_t key[16];
+    FILE *f = fopen( "/dev/urandom", "rb" );
+    size_t got = 0;
+
+    if ( NULL != f ) {
+        got = fread( key, 1, sizeof(key), f );
+        fclose( f );
+    }
+    if ( sizeof(key) != got ) {     // poor fallback: time and addresses
+        uint64_t seed[2];
+        seed[0] = (uint64_t)time( NULL ) ^ ( (uint64_t)clock() << 32 );
+        seed[1] = (uint64_t)(uintptr_t)&seed ^ (uint64_t)(uintptr_t)key ^
+                  (uint64_t)(uintptr_t)init_process_key;
+        memcpy( key, seed, sizeof(key) );
+    }
+    process_k0 = read64( key );
+    process_k1 = read64( key + 8 );
+}
+
+uint64_t siphash_64( uint8_t *data, size_t len )
+{
+    pthread_once( &process_key_once, init_process_key );
+    return _siphash13( process_k0, process_k1, data, len );
+}
+
+void siphash_64_set_key( const uint8_t key[16] )
+{
+    pthread_once( &process_key_once, init_process_key );
+    process_k0 = read64( key );
+    process_k1 = read64( key + 8 );
+}
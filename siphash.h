@@ -0,0 +1,38 @@
+
+#ifndef __SIPHASH_H__
+#define __SIPHASH_H__
+
+#include <stdlib.h>
+#include <stdint.h>
+
+/*
+    SipHash-1-3 keyed hash implementation
+
+    SipHash was designed by Jean-Philippe Aumasson and Daniel J. Bernstein
+    (https://131002.net/siphash/) as a fast pseudo-random function for short
+    inputs. SipHash-1-3 (1 compression round per 8-byte word, 3 finalization
+    rounds) is the variant used by Python and Rust for their hash tables.
+
+    Unlike fnv1a_64, fxhash_64, xxh64 or hash_64, the hash value depends on a
+    128-bit secret key. When keys of a map come from external input, an
+    attacker who does not know the secret key cannot craft keys that collide
+    in the map table, and therefore cannot force long collision chains and
+    repeated table re-allocations (hash flooding). The price is a lower
+    throughput, especially on long inputs (see hash_bench).
+
+    siphash_64 uses a secret key chosen randomly once per process, from
+    /dev/urandom if available, so that hash values differ between processes
+    and must not be stored or exchanged.
+*/
+
+// calculate SipHash-1-3 on a buffer with the given 16-byte secret key
+uint64_t siphash13( const uint8_t key[16], uint8_t *data, size_t len );
+
+// calculate SipHash-1-3 on a buffer with the per-process random key
+uint64_t siphash_64( uint8_t *data, size_t len );
+
+// replace the per-process random key (e.g. to get reproducible values in
+// tests). This must be done before hashing any key that is kept in a table.
+void siphash_64_set_key( const uint8_t key[16] );
+
+#endif /* __SIPHASH_H__ */
@@ -0,0 +1,350 @@
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <math.h>
+
+#include "sketch.h"
+#include "xxh64.h"
+
+// number of keys hashed (and whose counters are prefetched) together in batch
+// updates
+#define SKETCH_BATCH        16
+#define CMS_MAX_DEPTH       32
+
+#if defined( __GNUC__ )
+#define PREFETCH( addr )    __builtin_prefetch( addr, 1 )
+#else
+#define PREFETCH( addr )
+#endif
+
+/* ----------------------------- HyperLogLog -------------------------- */
+
+struct hll {
+    uint8_t     *registers;     // 2^precision registers
+    uint32_t    precision;
+};
+
+// number of leading zero bits in a non-zero value
+static inline uint32_t leading_zeros( uint64_t value )
+{
+#if defined( __GNUC__ )
+    return (uint32_t)__builtin_clzll( value );
+#else
+    uint32_t n = 0;
+    while ( 0 == ( value & ( (uint64_t)1 << 63 ) ) ) {
+        value <<= 1;
+        ++n;
+    }
+    return n;
+#endif
+}
+
+extern hll_t *new_hll( uint32_t precision )
+{
+    if ( precision < HLL_MIN_PRECISION || precision > HLL_MAX_PRECISION )
+        return NULL;
+
+    hll_t *hll = malloc( sizeof(hll_t) );
+    if ( NULL == hll ) return NULL;
+
+    hll->registers = calloc( (size_t)1 << precision, 1 );
+    if ( NULL == hll->registers ) {
+        free( hll );
+        return NULL;
+    }
+    hll->precision = precision;
+    return hll;
+}
+
+extern int hll_free( hll_t *hll )
+{
+    if ( NULL == hll ) return -1;
+    free( hll->registers );
+    free( hll );
+    return 0;
+}
+
+extern void hll_clear( hll_t *hll )
+{
+    if ( NULL == hll ) return;
+    memset( hll->registers, 0, (size_t)1 << hll->precision );
+}
+
+// the register is selected by the top precision bits of the hash, and its
+// value is the position of the first 1 bit in the remaining bits (a sentinel
+// bit limits that position to 64 - precision + 1).
+static inline void add_hash( hll_t *hll, uint64_t hash )
+{
+    uint32_t p = hll->precision;
+    size_t index = (size_t)( hash >> ( 64 - p ) );
+    uint64_t rest = ( hash << p ) | ( (uint64_t)1 << ( p - 1 ) );
+    uint8_t rank = (uint8_t)( leading_zeros( rest ) + 1 );
+
+    if ( rank > hll->registers[index] ) {
+        hll->registers[index] = rank;
+    }
+}
+
+extern void hll_add_hash( hll_t *hll, uint64_t hash )
+{
+    if ( NULL == hll ) return;
+    add_hash( hll, hash );
+}
+
+extern void hll_add( hll_t *hll, uint8_t *data, size_t len )
+{
+    if ( NULL == hll || NULL == data ) return;
+    add_hash( hll, xxh64( data, len ) );
+}
+
+extern void hll_add_hash_batch( hll_t *hll, const uint64_t hashes[], size_t n )
+{
+    if ( NULL == hll || NULL == hashes ) return;
+
+    for ( size_t i = 0; i < n; ++i ) {
+        add_hash( hll, hashes[i] );
+    }
+}
+
+extern void hll_add_batch( hll_t *hll, uint8_t *keys[], size_t lens[],
+                           size_t n )
+{
+    if ( NULL == hll || NULL == keys || NULL == lens ) return;
+
+    uint64_t hashes[SKETCH_BATCH];
+    for ( size_t i = 0; i < n; i += SKETCH_BATCH ) {
+        size_t count = ( n - i < SKETCH_BATCH ) ? n - i : SKETCH_BATCH;
+        for ( size_t j = 0; j < count; ++j ) {
+            hashes[j] = xxh64( keys[i + j], lens[i + j] );
+        }
+        for ( size_t j = 0; j < count; ++j ) {
+            add_hash( hll, hashes[j] );
+        }
+    }
+}
+
+extern bool hll_merge( hll_t *dst, const hll_t *src )
+{
+    if ( NULL == dst || NULL == src || dst->precision != src->precision )
+        return false;
+
+    size_t m = (size_t)1 << dst->precision;
+    for ( size_t i = 0; i < m; ++i ) {
+        if ( src->registers[i] > dst->registers[i] ) {
+            dst->registers[i] = src->registers[i];
+        }
+    }
+    return true;
+}
+
+extern double hll_count( const hll_t *hll )
+{
+    if ( NULL == hll ) return 0.0;
+
+    size_t m = (size_t)1 << hll->precision;
+    double alpha;
+    switch ( m ) {
+    case 16:    alpha = 0.673;  break;
+    case 32:    alpha = 0.697;  break;
+    case 64:    alpha = 0.709;  break;
+    default:    alpha = 0.7213 / ( 1.0 + 1.079 / (double)m );  break;
+    }
+
+    double sum = 0.0;
+    size_t zeros = 0;
+    for ( size_t i = 0; i < m; ++i ) {
+        sum += ldexp( 1.0, -(int)hll->registers[i] );
+        zeros += ( 0 == hll->registers[i] );
+    }
+
+    double estimate = alpha * (double)m * (double)m / sum;
+    if ( estimate <= 2.5 * (double)m && zeros ) {   // linear counting
+        estimate = (double)m * log( (double)m / (double)zeros );
+    }
+    return estimate;
+}
+
+/* --------------------------- count-min sketch ----------------------- */
+
+struct cms {
+    uint64_t    *counters;      // depth rows of width counters
+    uint64_t    total;
+    size_t      width;
+    uint32_t    width_bits;     // width is 2^width_bits
+    uint32_t    depth;
+};
+
+extern cms_t *new_cms( size_t width, uint32_t depth )
+{
+    if ( 0 == width || 0 == depth || depth > CMS_MAX_DEPTH ) return NULL;
+
+    uint32_t bits = 1;
+    while ( ( (size_t)1 << bits ) < width ) {
+        if ( ++bits >= 8 * sizeof(size_t) - 4 ) return NULL;
+    }
+
+    cms_t *cms = malloc( sizeof(cms_t) );
+    if ( NULL == cms ) return NULL;
+
+    cms->width = (size_t)1 << bits;
+    cms->counters = calloc( cms->width * depth, sizeof(uint64_t) );
+    if ( NULL == cms->counters ) {
+        free( cms );
+        return NULL;
+    }
+    cms->total = 0;
+    cms->width_bits = bits;
+    cms->depth = depth;
+    return cms;
+}
+
+extern cms_t *new_cms_with_error( double epsilon, double delta )
+{
+    if ( ! ( epsilon > 0.0 && epsilon < 1.0 && delta > 0.0 && delta < 1.0 ) )
+        return NULL;
+
+    double width = ceil( exp( 1.0 ) / epsilon );
+    double depth = ceil( log( 1.0 / delta ) );
+    if ( width > (double)( (size_t)1 << 40 ) || depth > CMS_MAX_DEPTH )
+        return NULL;
+    return new_cms( (size_t)width, ( depth < 1.0 ) ? 1 : (uint32_t)depth );
+}
+
+extern int cms_free( cms_t *cms )
+{
+    if ( NULL == cms ) return -1;
+    free( cms->counters );
+    free( cms );
+    return 0;
+}
+
+extern void cms_clear( cms_t *cms )
+{
+    if ( NULL == cms ) return;
+    memset( cms->counters, 0, sizeof(uint64_t) * cms->width * cms->depth );
+    cms->total = 0;
+}
+
+// set the counter index of a key in each row. Row indexes are the top bits of
+// a 64-bit sequence seeded by the hash and advanced by one multiplication per
+// row, so that a single hash gives independent looking indexes in all rows.
+static inline void row_indexes( const cms_t *cms, uint64_t hash,
+                                size_t indexes[] )
+{
+    uint64_t h = hash;
+    for ( uint32_t r = 0; r < cms->depth; ++r ) {
+        h = h * 0x9e3779b97f4a7c15 + 0x632be59bd9b4e019;
+        indexes[r] = r * cms->width + (size_t)( h >> ( 64 - cms->width_bits ) );
+    }
+}
+
+static inline void add_indexes( cms_t *cms, const size_t indexes[],
+                                uint64_t count )
+{
+    for ( uint32_t r = 0; r < cms->depth; ++r ) {
+        cms->counters[indexes[r]] += count;
+    }
+    cms->total += count;
+}
+
+extern void cms_add_hash( cms_t *cms, uint64_t hash, uint64_t count )
+{
+    if ( NULL == cms ) return;
+
+    size_t indexes[CMS_MAX_DEPTH];
+    row_indexes( cms, hash, indexes );
+    add_indexes( cms, indexes, count );
+}
+
+extern void cms_add( cms_t *cms, uint8_t *data, size_t len, uint64_t count )
+{
+    if ( NULL == cms || NULL == data ) return;
+    cms_add_hash( cms, xxh64( data, len ), count );
+}
+
+// add up to SKETCH_BATCH hashes: all counters are prefetched before updating
+// the first one, so that their cache misses overlap.
+static void add_batch( cms_t *cms, const uint64_t hashes[],
+                       const uint64_t counts[], size_t n )
+{
+    size_t indexes[SKETCH_BATCH][CMS_MAX_DEPTH];
+
+    for ( size_t i = 0; i < n; ++i ) {
+        row_indexes( cms, hashes[i], indexes[i] );
+        for ( uint32_t r = 0; r < cms->depth; ++r ) {
+            PREFETCH( &cms->counters[ indexes[i][r] ] );
+        }
+    }
+    for ( size_t i = 0; i < n; ++i ) {
+        add_indexes( cms, indexes[i], ( counts ) ? counts[i] : 1 );
+    }
+}
+
+extern void cms_add_hash_batch( cms_t *cms, const uint64_t hashes[],
+                                const uint64_t counts[], size_t n )
+{
+    if ( NULL == cms || NULL == hashes ) return;
+
+    for ( size_t i = 0; i < n; i += SKETCH_BATCH ) {
+        size_t count = ( n - i < SKETCH_BATCH ) ? n - i : SKETCH_BATCH;
+        add_batch( cms, &hashes[i], ( counts ) ? &counts[i] : NULL, count );
+    }
+}
+
+extern void cms_add_batch( cms_t *cms, uint8_t *keys[], size_t lens[],
+                           const uint64_t counts[], size_t n )
+{
+    if ( NULL == cms || NULL == keys || NULL == lens ) return;
+
+    uint64_t hashes[SKETCH_BATCH];
+    for ( size_t i = 0; i < n; i += SKETCH_BATCH ) {
+        size_t count = ( n - i < SKETCH_BATCH ) ? n - i : SKETCH_BATCH;
+        for ( size_t j = 0; j < count; ++j ) {
+            hashes[j] = xxh64( keys[i + j], lens[i + j] );
+        }
+        add_batch( cms, hashes, ( counts ) ? &counts[i] : NULL, count );
+    }
+}
+
+extern uint64_t cms_estimate_hash( const cms_t *cms, uint64_t hash )
+{
+    if ( NULL == cms ) return 0;
+
+    size_t indexes[CMS_MAX_DEPTH];
+    row_indexes( cms, hash, indexes );
+
+    uint64_t estimate = UINT64_MAX;
+    for ( uint32_t r = 0; r < cms->depth; ++r ) {
+        if ( cms->counters[indexes[r]] < estimate ) {
+            estimate = cms->counters[indexes[r]];
+        }
+    }
+    return estimate;
+}
+
+extern uint64_t cms_estimate( const cms_t *cms, uint8_t *data, size_t len )
+{
+    if ( NULL == cms || NULL == data ) return 0;
+    return cms_estimate_hash( cms, xxh64( data, len ) );
+}
+
+extern uint64_t cms_total( const cms_t *cms )
+{
+    if ( NULL == cms ) return 0;
+    return cms->total;
+}
+
+extern bool cms_merge( cms_t *dst, const cms_t *src )
+{
+    if ( NULL == dst || NULL == src ||
+         dst->width != src->width || dst->depth != src->depth )
+        return false;
+
+    size_t n = dst->width * dst->depth;
+    for ( size_t i = 0; i < n; ++i ) {
+        dst->counters[i] += src->counters[i];
+    }
+    dst->total += src->total;
+    return true;
+}
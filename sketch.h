@@ -0,0 +1,117 @@
+
+#ifndef __SKETCH_H__
+#define __SKETCH_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/*
+    Probabilistic counting: HyperLogLog and count-min sketch
+
+    Both structures use a fixed amount of memory, whatever the number of keys
+    added, instead of a map_t entry per distinct key:
+
+    - HyperLogLog estimates the number of distinct keys, with a relative
+      standard error of 1.04 / sqrt(2^precision), using 2^precision one-byte
+      registers (e.g. 0.8% with precision 14, in 16 KB).
+
+    - A count-min sketch estimates how many times each key was added (e.g. to
+      find heavy hitters), using depth rows of width counters. An estimate is
+      never below the real count, and is above it by at most epsilon times
+      the total count with a probability of at least 1 - delta.
+
+    Keys are hashed once with xxh64 (see xxh64.h), which gives the same values
+    on all hosts. The _hash functions take a 64-bit hash value that was already
+    calculated by the caller, which must then use the same hash function for
+    all keys of a sketch and of all sketches merged together.
+
+    Sketches of the same dimensions can be merged: each thread can add keys
+    to its own sketch without locking, and the per-thread sketches are merged
+    at the end into a sketch identical to the one that would have been obtained
+    by adding all keys to a single sketch. The same sketch must not be updated
+    by multiple threads at the same time.
+
+    Estimates and count-min sizing use the math library: the program must be
+    linked with -lm.
+*/
+
+typedef struct hll hll_t;
+
+// minimum and maximum HyperLogLog precision (number of index bits)
+#define HLL_MIN_PRECISION   4
+#define HLL_MAX_PRECISION   18
+
+// allocate a new empty HyperLogLog with 2^precision registers. It returns NULL
+// if precision is not in [HLL_MIN_PRECISION, HLL_MAX_PRECISION] or in case of
+// failure (no memory).
+extern hll_t *new_hll( uint32_t precision );
+
+// free an existing HyperLogLog.
+extern int hll_free( hll_t *hll );
+
+// reset a HyperLogLog to its initial empty state.
+extern void hll_clear( hll_t *hll );
+
+// add a key given by its data and length, or by its 64-bit hash value.
+extern void hll_add( hll_t *hll, uint8_t *data, size_t len );
+extern void hll_add_hash( hll_t *hll, uint64_t hash );
+
+// add n keys given by the arrays keys and lens, or by the array hashes.
+extern void hll_add_batch( hll_t *hll, uint8_t *keys[], size_t lens[],
+                           size_t n );
+extern void hll_add_hash_batch( hll_t *hll, const uint64_t hashes[],
+                                size_t n );
+
+// merge src into dst, which must have the same precision. It returns false if
+// the precisions differ, true otherwise.
+extern bool hll_merge( hll_t *dst, const hll_t *src );
+
+// return the estimated number of distinct keys added so far.
+extern double hll_count( const hll_t *hll );
+
+typedef struct cms cms_t;
+
+// allocate a new count-min sketch with depth rows of at least width counters
+// (width is rounded up to a power of 2). It returns NULL if width or depth is
+// 0 or in case of failure (no memory).
+extern cms_t *new_cms( size_t width, uint32_t depth );
+
+// allocate a new count-min sketch sized so that the estimate error is at most
+// epsilon times the total count with a probability of at least 1 - delta (both
+// between 0 and 1 excluded). It returns NULL in case of wrong arguments or
+// failure (no memory).
+extern cms_t *new_cms_with_error( double epsilon, double delta );
+
+// free an existing count-min sketch.
+extern int cms_free( cms_t *cms );
+
+// reset a count-min sketch to its initial empty state.
+extern void cms_clear( cms_t *cms );
+
+// add count occurrences of a key given by its data and length, or by its
+// 64-bit hash value.
+extern void cms_add( cms_t *cms, uint8_t *data, size_t len, uint64_t count );
+extern void cms_add_hash( cms_t *cms, uint64_t hash, uint64_t count );
+
+// add n keys given by the arrays keys and lens, or by the array hashes. The
+// array counts gives the number of occurrences of each key, or if counts is
+// NULL each key is added once.
+extern void cms_add_batch( cms_t *cms, uint8_t *keys[], size_t lens[],
+                           const uint64_t counts[], size_t n );
+extern void cms_add_hash_batch( cms_t *cms, const uint64_t hashes[],
+                                const uint64_t counts[], size_t n );
+
+// return the estimated number of occurrences of a key given by its data and
+// length, or by its 64-bit hash value.
+extern uint64_t cms_estimate( const cms_t *cms, uint8_t *data, size_t len );
+extern uint64_t cms_estimate_hash( const cms_t *cms, uint64_t hash );
+
+// return the total count of all keys added so far.
+extern uint64_t cms_total( const cms_t *cms );
+
+// merge src into dst, which must have the same width and depth. It returns
+// false if the dimensions differ, true otherwise.
+extern bool cms_merge( cms_t *dst, const cms_t *src );
+
+#endif /* __SKETCH_H__ */
@@ -0,0 +1,339 @@
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <pthread.h>
+
+#include "slab.h"
+
+#define SLAB_CHUNK_SIZE     65536   // objects are allocated by chunks
+
+typedef struct magazine {
+    struct magazine *next;          // in depot lists
+    size_t          count;          // number of objects
+    void            *objects[SLAB_MAGAZINE_SIZE];
+} magazine_t;
+
+typedef struct chunk {
+    struct chunk    *next;
+} chunk_t;
+
+// thread-local cache: objects are allocated from loaded and freed to loaded,
+// previous is used before exchanging magazines with the depot.
+typedef struct {
+    slab_t          *slab;
+    magazine_t      *loaded;
+    magazine_t      *previous;
+} slab_cache_t;
+
+struct slab {
+    size_t          object_size;
+    pthread_key_t   key;            // thread-local slab_cache_t
+    pthread_mutex_t lock;           // for all fields below
+    magazine_t      *full;          // depot of non-empty magazines
+    magazine_t      *empty;         // depot of empty magazines
+    void            *objects;       // free objects without magazine
+    chunk_t         *chunks;        // all chunks, for slab_free
+    uint8_t         *top;           // next new object in current chunk
+    uint8_t         *end;           // end of current chunk
+};
+
+static inline size_t round_up( size_t size, size_t multiple )
+{
+    return ( size + multiple - 1 ) / multiple * multiple;
+}
+
+static inline size_t chunk_header( const slab_t *slab )
+{
+    return round_up( sizeof(chunk_t), ( slab->object_size % 16 ) ? 8 : 16 );
+}
+
+// take a new object from the current chunk, or from a new chunk. It must be
+// called with the depot lock.
+static void *new_object( slab_t *slab )
+{
+    if ( slab->top + slab->object_size > slab->end ) {
+        size_t header = chunk_header( slab );
+        size_t size = SLAB_CHUNK_SIZE;
+        if ( size < header + slab->object_size ) {
+            size = header + slab->object_size;
+        }
+        chunk_t *chunk = malloc( size );
+        if ( NULL == chunk ) return NULL;
+
+        chunk->next = slab->chunks;
+        slab->chunks = chunk;
+        slab->top = (uint8_t *)chunk + header;
+        slab->end = (uint8_t *)chunk + size;
+    }
+    void *object = slab->top;
+    slab->top += slab->object_size;
+    return object;
+}
+
+// give back the magazines of an exiting thread to the depot
+static void release_cache( void *value )
+{
+    slab_cache_t *cache = value;
+    slab_t *slab = cache->slab;
+    magazine_t *magazines[2] = { cache->loaded, cache->previous };
+
+    pthread_mutex_lock( &slab->lock );
+    for ( int i = 0; i < 2; ++i ) {
+        magazine_t *magazine = magazines[i];
+        if ( magazine->count ) {
+            magazine->next = slab->full;
+            slab->full = magazine;
+        } else {
+            magazine->next = slab->empty;
+            slab->empty = magazine;
+        }
+    }
+    pthread_mutex_unlock( &slab->lock );
+    free( cache );
+}
+
+static slab_cache_t *get_cache( slab_t *slab )
+{
+    slab_cache_t *cache = pthread_getspecific( slab->key );
+    if ( NULL != cache ) return cache;
+
+    cache = malloc( sizeof(slab_cache_t) );
+    magazine_t *loaded = calloc( 1, sizeof(magazine_t) );
+    magazine_t *previous = calloc( 1, sizeof(magazine_t) );
+    if ( NULL == cache || NULL == loaded || NULL == previous ||
+         0 != pthread_setspecific( slab->key, cache ) ) {
+        free( cache );
+        free( loaded );
+        free( previous );
+        return NULL;
+    }
+    cache->slab = slab;
+    cache->loaded = loaded;
+    cache->previous = previous;
+    return cache;
+}
+
+extern slab_t *new_slab( size_t object_size )
+{
+    if ( 0 == object_size ) return NULL;
+
+    slab_t *slab = malloc( sizeof(slab_t) );
+    if ( NULL == slab ) return NULL;
+
+    // objects hold a pointer when they are in the free object list
+    if ( object_size < sizeof(void *) ) object_size = sizeof(void *);
+    slab->object_size = round_up( object_size, sizeof(void *) );
+    if ( 0 != pthread_key_create( &slab->key, release_cache ) ) {
+        free( slab );
+        return NULL;
+    }
+    if ( 0 != pthread_mutex_init( &slab->lock, NULL ) ) {
+        pthread_key_delete( slab->key );
+        free( slab );
+        return NULL;
+    }
+    slab->full = slab->empty = NULL;
+    slab->objects = NULL;
+    slab->chunks = NULL;
+    slab->top = slab->end = NULL;
+    return slab;
+}
+
+extern size_t slab_object_size( const slab_t *slab )
+{
+    if ( NULL == slab ) return 0;
+    return slab->object_size;
+}
+
+// fill an empty magazine with free objects and then new objects, so that the
+// depot is locked once per magazine instead of once per object. It must be
+// called with the depot lock.
+static void fill_magazine( slab_t *slab, magazine_t *magazine )
+{
+    while ( magazine->count < SLAB_MAGAZINE_SIZE ) {
+        void *object = slab->objects;
+        if ( NULL != object ) {
+            slab->objects = *(void **)object;
+        } else if ( NULL == ( object = new_object( slab ) ) ) {
+            break;
+        }
+        magazine->objects[ magazine->count++ ] = object;
+    }
+}
+
+// add count objects to the free object list. It must be called with the
+// depot lock.
+static void push_objects( slab_t *slab, void **objects, size_t count )
+{
+    for ( size_t i = 0; i < count; ++i ) {
+        *(void **)objects[i] = slab->objects;
+        slab->objects = objects[i];
+    }
+}
+
+// allocate without a thread-local cache (no memory for it)
+static void *depot_alloc( slab_t *slab )
+{
+    pthread_mutex_lock( &slab->lock );
+    void *object = slab->objects;
+    if ( NULL != object ) {
+        slab->objects = *(void **)object;
+    } else if ( NULL != slab->full ) {
+        magazine_t *magazine = slab->full;
+        object = magazine->objects[ --magazine->count ];
+        if ( 0 == magazine->count ) {
+            slab->full = magazine->next;
+            magazine->next = slab->empty;
+            slab->empty = magazine;
+        }
+    } else {
+        object = new_object( slab );
+    }
+    pthread_mutex_unlock( &slab->lock );
+    return object;
+}
+
+// free without a thread-local cache or magazine (no memory for it)
+static void depot_release( slab_t *slab, void *object )
+{
+    pthread_mutex_lock( &slab->lock );
+    push_objects( slab, &object, 1 );
+    pthread_mutex_unlock( &slab->lock );
+}
+
+extern void *slab_alloc( slab_t *slab )
+{
+    if ( NULL == slab ) return NULL;
+
+    slab_cache_t *cache = get_cache( slab );
+    if ( NULL == cache ) return depot_alloc( slab );
+
+    magazine_t *loaded = cache->loaded;
+    if ( loaded->count ) return loaded->objects[ --loaded->count ];
+
+    if ( cache->previous->count ) {     // use previous objects first
+        cache->loaded = cache->previous;
+        cache->previous = loaded;
+        return cache->loaded->objects[ --cache->loaded->count ];
+    }
+
+    // both magazines are empty: exchange one with a full one from the depot,
+    // or fill one if there is none.
+    pthread_mutex_lock( &slab->lock );
+    magazine_t *full = slab->full;
+    if ( NULL == full ) {
+        fill_magazine( slab, loaded );
+        pthread_mutex_unlock( &slab->lock );
+        if ( 0 == loaded->count ) return NULL;
+        return loaded->objects[ --loaded->count ];
+    }
+    slab->full = full->next;
+    magazine_t *empty = cache->previous;
+    empty->next = slab->empty;
+    slab->empty = empty;
+    pthread_mutex_unlock( &slab->lock );
+
+    cache->previous = loaded;
+    cache->loaded = full;
+    return full->objects[ --full->count ];
+}
+
+extern void slab_release( slab_t *slab, void *object )
+{
+    if ( NULL == slab || NULL == object ) return;
+
+    slab_cache_t *cache = get_cache( slab );
+    if ( NULL == cache ) {
+        depot_release( slab, object );
+        return;
+    }
+
+    magazine_t *loaded = cache->loaded;
+    if ( loaded->count < SLAB_MAGAZINE_SIZE ) {
+        loaded->objects[ loaded->count++ ] = object;
+        return;
+    }
+    if ( 0 == cache->previous->count ) {    // use previous room first
+        cache->loaded = cache->previous;
+        cache->previous = loaded;
+        cache->loaded->objects[ cache->loaded->count++ ] = object;
+        return;
+    }
+
+    // both magazines are full: exchange one with an empty one from the depot
+    magazine_t *full = cache->previous;
+    pthread_mutex_lock( &slab->lock );
+    magazine_t *empty = slab->empty;
+    if ( NULL != empty ) {
+        slab->empty = empty->next;
+    } else {                            // allocate it without the lock
+        pthread_mutex_unlock( &slab->lock );
+        empty = malloc( sizeof(magazine_t) );
+        pthread_mutex_lock( &slab->lock );
+    }
+    if ( NULL != empty ) {
+        full->next = slab->full;
+        slab->full = full;
+    } else {    // no memory for a magazine: reuse full without its objects
+        push_objects( slab, full->objects, full->count );
+        empty = full;
+    }
+    pthread_mutex_unlock( &slab->lock );
+
+    empty->count = 0;
+    cache->previous = loaded;
+    cache->loaded = empty;
+    empty->objects[ empty->count++ ] = object;
+}
+
+static void free_magazines( magazine_t *magazine )
+{
+    while ( NULL != magazine ) {
+        magazine_t *next = magazine->next;
+        free( magazine );
+        magazine = next;
+    }
+}
+
+extern void slab_free( slab_t *slab )
+{
+    if ( NULL == slab ) return;
+
+    slab_cache_t *cache = pthread_getspecific( slab->key );
+    if ( NULL != cache ) {
+        free( cache->loaded );
+        free( cache->previous );
+        free( cache );
+    }
+    pthread_key_delete( slab->key );
+    pthread_mutex_destroy( &slab->lock );
+
+    free_magazines( slab->full );
+    free_magazines( slab->empty );
+    chunk_t *next;
+    for ( chunk_t *chunk = slab->chunks; chunk != NULL; chunk = next ) {
+        next = chunk->next;
+        free( chunk );
+    }
+    free( slab );
+}
+
+#define SHARED_SLABS        ( SLAB_SHARED_MAX / 16 )
+
+static slab_t *shared_slabs[ SHARED_SLABS ];
+static pthread_mutex_t shared_lock = PTHREAD_MUTEX_INITIALIZER;
+
+extern slab_t *shared_slab( size_t object_size )
+{
+    if ( 0 == object_size || object_size > SLAB_SHARED_MAX ) return NULL;
+
+    size_t index = ( object_size - 1 ) / 16;
+    pthread_mutex_lock( &shared_lock );
+    if ( NULL == shared_slabs[ index ] ) {
+        shared_slabs[ index ] = new_slab( ( index + 1 ) * 16 );
+    }
+    slab_t *slab = shared_slabs[ index ];
+    pthread_mutex_unlock( &shared_lock );
+    return slab;
+}
@@ -0,0 +1,66 @@
+
+#ifndef __SLAB_H__
+#define __SLAB_H__
+
+#include <stddef.h>
+
+/*
+    Slab cache for fixed-size objects
+
+    A slab cache allocates objects of a single size from large chunks, and
+    keeps freed objects for reuse instead of returning them to malloc. Each
+    thread has its own cache made of 2 magazines (small stacks of free
+    objects), from which objects are allocated and to which they are freed
+    without any lock. Only when both magazines are empty (allocating) or full
+    (freeing), a full or empty magazine is exchanged with a global depot under
+    a mutex. If the depot has no full magazine, an empty magazine is filled
+    with free or new objects at once, so that a thread allocating more than
+    it frees (e.g. a producer) locks the depot once per magazine, not once per
+    object. In steady state, when objects are allocated and freed at the same
+    rate, a thread never locks the depot nor calls malloc.
+
+    Objects may be freed by a different thread than the thread that allocated
+    them. When a thread exits, its magazines are given back to the depot.
+    Memory is never returned to the system until the slab is freed.
+
+    Fifo, queue and map use process-wide slabs (see shared_slab) for their
+    list entries and collision entries, when they use the default malloc
+    allocator (see alloc.h).
+
+    The library must be linked with -lpthread.
+*/
+
+typedef struct slab slab_t;
+
+// number of objects in a magazine
+#define SLAB_MAGAZINE_SIZE  64
+
+// create a new slab cache for objects of object_size bytes. Objects are
+// aligned on the size of a pointer, or on 16 bytes if object_size is a
+// multiple of 16. It returns NULL in case of failure (no memory).
+extern slab_t *new_slab( size_t object_size );
+
+// return the object size of the slab, possibly rounded up, or 0 if the
+// argument slab is NULL.
+extern size_t slab_object_size( const slab_t *slab );
+
+// allocate an object. It returns NULL in case of failure (no memory).
+extern void *slab_alloc( slab_t *slab );
+
+// give back an object to the slab.
+extern void slab_release( slab_t *slab, void *object );
+
+// free the slab and all its objects. No other thread may be using the slab,
+// and the thread-local caches of other threads are not released.
+extern void slab_free( slab_t *slab );
+
+// maximum object size for shared_slab
+#define SLAB_SHARED_MAX     128
+
+// return a process-wide slab for objects of object_size bytes, which is never
+// freed. Object sizes are rounded up to a multiple of 16 bytes, so that
+// objects of similar sizes share a slab. It returns NULL if object_size is
+// larger than SLAB_SHARED_MAX or in case of failure (no memory).
+extern slab_t *shared_slab( size_t object_size );
+
+#endif /* __SLAB_H__ */
@@ -14,9 +14,11 @@ extern slice_t *new_slice_with_vector( vector_t *vector, size_t len )
 {
     if ( vector == NULL ) return NULL;
 
-    slice_t *slice = malloc( sizeof( slice_t ) );
+    slice_t *slice = allocator_alloc( vector->allocator, sizeof( slice_t ) );
     if ( slice ) {
         slice->vector = vector;
+        slice->allocator = vector->allocator;
+        slice->use = NULL;
         slice->start = 0;
         slice->len = len;
     }
@@ -29,6 +31,34 @@ extern slice_t *new_slice( size_t item_size, size_t number )
     return new_slice_with_vector( vector, 0 );
 }
 
+extern slice_t *new_slice_with_allocator( size_t item_size, size_t number,
+                                          const allocator_t *allocator )
+{
+    vector_t *vector = new_vector_with_allocator( item_size, number,
+                                                  allocator );
+    return new_slice_with_vector( vector, 0 );
+}
+
+extern slice_t *new_slice_zeroed( size_t item_size, size_t number )
+{
+    vector_t *vector = new_vector_zeroed( item_size, number );
+    return new_slice_with_vector( vector, number );
+}
+
+extern slice_t *new_slice_aligned( size_t item_size, size_t number,
+                                   size_t alignment )
+{
+    vector_t *vector = new_vector_aligned( item_size, number, alignment );
+    return new_slice_with_vector( vector, 0 );
+}
+
+extern slice_t *new_slice_padded( size_t item_size, size_t number,
+                                  size_t alignment )
+{
+    vector_t *vector = new_vector_padded( item_size, number, alignment );
+    return new_slice_with_vector( vector, 0 );
+}
+
 extern slice_t *new_slice_from_data( const void *data,
                                      size_t item_size, size_t number )
 {
@@ -44,10 +74,12 @@ extern slice_t *new_slice_from_slice( const slice_t *slice,
     if ( NULL == slice || start > beyond ||
         beyond > _slice_len( slice ) ) return NULL;
 
-    slice_t *new_slice = malloc( sizeof( slice_t ) );
+    slice_t *new_slice = allocator_alloc( slice->allocator, sizeof( slice_t ) );
     if ( NULL != new_slice ) {
         vector_share( slice->vector );
         new_slice->vector = slice->vector;
+        new_slice->allocator = slice->allocator;
+        new_slice->use = NULL;
         new_slice->start = slice->start + start;
         new_slice->len = beyond - start;
     }
@@ -62,10 +94,22 @@ extern slice_t *slice_dup( const slice_t * slice )
     return new_slice_from_slice( slice, 0, slice->len );
 }
 
+extern int slice_unshare( slice_t *slice )
+{
+    if ( NULL == slice || ! _slice_make_private( slice, 0 ) ) return -1;
+    return 0;
+}
+
+extern int slice_set_atomic( slice_t *slice )
+{
+    if ( NULL == slice ) return -1;
+    return vector_set_atomic( slice->vector );
+}
+
 
 // set all items in the slice [0..len] to 0.
 extern void slice_zero( slice_t *slice ) {
-    if ( NULL != slice ) {
+    if ( NULL != slice && _slice_make_private( slice, 0 ) ) {
         vector_segment_zero( slice->vector, slice->start, slice->len );
     }
 }
@@ -121,6 +165,12 @@ extern size_t slice_item_size( const slice_t * slice )
     return _vector_item_size( slice->vector );
 }
 
+extern size_t slice_stride( const slice_t * slice )
+{
+    if ( NULL == slice ) return 0;
+    return _vector_stride( slice->vector );
+}
+
 extern void * slice_item_at( const slice_t *slice, size_t index )
 {
     if ( NULL == slice || index >= slice->len ) return 0;
@@ -137,7 +187,8 @@ extern void * pointer_slice_item_at( const slice_t *slice, size_t index )
 extern int slice_write_item_at( slice_t *slice,
                                 size_t index, const void * data )
 {
-    if ( NULL == slice || NULL == data || index >= slice->len ) return -1;
+    if ( NULL == slice || NULL == data || index >= slice->len ||
+         ! _slice_make_private( slice, 0 ) ) return -1;
     _slice_write_item_at( slice, index, data );
     return 0;
 }
@@ -146,7 +197,7 @@ extern int pointer_slice_write_item_at( slice_t *slice,
                                         size_t index, const void * data )
 {
     if ( NULL == slice || _vector_item_size(slice->vector) != sizeof(void *) ||
-         index >= slice->len ) return -1;
+         index >= slice->len || ! _slice_make_private( slice, 0 ) ) return -1;
     _pointer_slice_write_item_at( slice, index, data );
     return 0;
 }
@@ -188,7 +239,8 @@ extern int pointer_slice_insert_item_at( slice_t *slice, size_t index,
 
 extern int slice_remove_item_at( slice_t *slice, size_t index )
 {
-    if ( NULL == slice || index >= slice->len ) return -1;
+    if ( NULL == slice || index >= slice->len ||
+         ! _slice_make_private( slice, 0 ) ) return -1;
     if ( -1 == vector_move_items( slice->vector,
                     slice->start + index, slice->start + slice->len, -1 ) ) {
         return -1;
@@ -201,7 +253,8 @@ extern int slice_move_items_from( slice_t *slice,
 {
     if ( NULL == slice || index + len > slice->len ||
         (ssize_t)index + offset < 0 ||
-        (ssize_t)index + (ssize_t)len + offset > (ssize_t)slice->len ) {
+        (ssize_t)index + (ssize_t)len + offset > (ssize_t)slice->len ||
+        ! _slice_make_private( slice, 0 ) ) {
         return -1;
     }
     if ( -1 == vector_move_items( slice->vector,
@@ -259,13 +312,14 @@ static inline void _swap_uint64( void *start,
 extern int slice_swap_items( slice_t *slice, size_t index1, size_t index2 )
 {
     if ( NULL == slice || index1 == index2 ||
-         index1 >= slice->len || index2 >= slice->len )
+         index1 >= slice->len || index2 >= slice->len ||
+         ! _slice_make_private( slice, 0 ) )
         return -1;
 
     size_t item_size = _vector_item_size( slice->vector );
     void *start = _vector_index_ptr_at( slice->vector, slice->start );
-    size_t offset1 = index1 * item_size;
-    size_t offset2 = index2 * item_size;
+    size_t offset1 = index1 * _vector_stride( slice->vector );
+    size_t offset2 = index2 * _vector_stride( slice->vector );
 
     if ( item_size >= 8 ) {
         _swap_uint64( start, offset1, offset2, item_size / 8 );
@@ -304,16 +358,58 @@ extern int pointer_slice_append_item( slice_t *slice, const void * data )
     return _pointer_slice_append_item( slice, data );
 }
 
+extern int slice_reserve( slice_t *slice, size_t number )
+{
+    if ( NULL == slice ) return -1;
+
+    vector_t *vector = vector_reserve( slice->vector, slice->start + number );
+    if ( NULL == vector ) return -1;
+    slice->vector = vector;
+    return 0;
+}
+
+extern int slice_shrink_to_fit( slice_t *slice )
+{
+    if ( NULL == slice ) return -1;
+
+    size_t number = slice->start + slice->len;
+    if ( 0 == number ) return 0;
+
+    vector_t *vector = vector_shrink_to_fit( slice->vector, number );
+    if ( NULL == vector ) return -1;
+    slice->vector = vector;
+    return 0;
+}
 
 extern int slice_free( slice_t *slice )
 {
     if ( NULL == slice ) return -1;
 
     vector_free( slice->vector );
-    free( slice );
+    allocator_free( slice->allocator, slice, sizeof( slice_t ) );
     return 0;
 }
 
+extern void *slice_release_data( slice_t *slice, size_t *lenp )
+{
+    if ( NULL == slice || ! _slice_make_private( slice, 0 ) ) return NULL;
+
+    size_t len = slice->len;
+    if ( slice->start && len ) {
+        memmove( _vector_index_ptr_at( slice->vector, 0 ),
+                 _vector_index_ptr_at( slice->vector, slice->start ),
+                 _vector_stride( slice->vector ) * len );
+    }
+    slice->start = 0;
+
+    void *data = vector_release_data( slice->vector );
+    if ( NULL == data ) return NULL;
+
+    allocator_free( slice->allocator, slice, sizeof( slice_t ) );
+    if ( lenp ) { *lenp = len; }
+    return data;
+}
+
 extern void slice_process_items( const slice_t *slice, item_process_fct fct,
                                  void *context )
 {
@@ -325,21 +421,24 @@ extern int pointer_slice_free( slice_t *slice )
 {
     if ( NULL == slice ) return -1;
 
-    size_t n = slice_len( slice );
-    for ( size_t i = 0; i < n; ++i ) {
-        free( pointer_slice_item_at( slice, i ) );
-        pointer_slice_write_item_at( slice, i, NULL ); // in case of shared vector
+    if ( sizeof(void *) == _slice_item_size( slice ) ) {
+        size_t n = _slice_len( slice );
+        for ( size_t i = 0; i < n; ++i ) {
+            free( _pointer_slice_item_at( slice, i ) );
+            // in case of shared vector, clear pointers in place without a copy
+            _pointer_slice_write_item_at( slice, i, NULL );
+        }
     }
     return slice_free( slice );
 }
 
 extern bool slice_sort_items( slice_t *slice, comp_fct cmp )
 {
-    if ( NULL == slice || NULL == cmp ) {
+    if ( NULL == slice || NULL == cmp || ! _slice_make_private( slice, 0 ) ) {
         return false;
     }
     qsort( _slice_item_at( slice, 0 ), _slice_len( slice ),
-           _vector_item_size( slice->vector ),  cmp );
+           _vector_stride( slice->vector ),  cmp );
     return true;
 }
 
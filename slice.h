@@ -12,8 +12,13 @@
     slice, i.e. to first increment the length and set the last item value.
     Capacity is the size currently available within the current array, which
     might change any time an item is appended to the slice. Multiple slices can
-    share the same array, which means that the array value can change for all
-    those slices whenever an item is set through one of the slices.
+    share the same array without copying it (see new_slice_from_slice and
+    slice_dup). Shared arrays are copied on write: the first modification of a
+    slice whose array is shared (writing, inserting, removing, moving, swapping,
+    zeroing, sorting or appending items) copies the slice items into a new
+    array for that slice only, so that the other slices keep their values.
+    Items modified directly through pointers returned by slice_item_at or
+    slice_data_n_len are not copied: call slice_unshare before doing that.
 
     array:   0 1 2 3 4 5 6 7 8 9 a b c d e f size=16
             [I I I I I I I I I I I I I I I I]
@@ -55,16 +60,39 @@ typedef struct slice slice_t;
 // Initially, start=0, length=0 (beyond=start) and capacity=number.
 extern slice_t *new_slice( size_t item_size, size_t number );
 
+// same as new_slice, but the slice and its array are allocated with the given
+// allocator (see alloc.h), or with the default allocator if it is NULL.
+extern slice_t *new_slice_with_allocator( size_t item_size, size_t number,
+                                          const allocator_t *allocator );
+
 // create a new slice with a new array of number items, each of item_size size.
 // The slice is created with start=0, length=number and capacity=number, and
 // the given data area is copied in the array.
 extern slice_t *new_slice_from_data( const void *data,
                                      size_t item_size, size_t number );
 
+// create a new slice with a new array of number items, each of item_size size,
+// initialized to 0 as new_vector_zeroed does. The slice is created with
+// start=0, length=number and capacity=number.
+extern slice_t *new_slice_zeroed( size_t item_size, size_t number );
+
+// create a new slice with a new aligned array, as new_slice_aligned does
+// for vectors (see vector.h). Initially, start=0, length=0 (beyond=start) and
+// capacity=number. Note that only the first item of a slice with start=0 is
+// guaranteed to be aligned.
+extern slice_t *new_slice_aligned( size_t item_size, size_t number,
+                                   size_t alignment );
+
+// create a new slice with a new aligned array, and a distance between items
+// rounded up to a power of 2, as new_vector_padded does for vectors.
+extern slice_t *new_slice_padded( size_t item_size, size_t number,
+                                  size_t alignment );
+
 // create a new slice with the given vector. The slice is created with start=0,
 // length=number and capacity=vector_cap( vector ). The vector is now managed
 // by the slice, and will atomatically grow as needed by the slice. It will be
 // deleted when the slice is deleted, unless it is shared with other objects.
+// The slice is allocated with the vector allocator.
 extern slice_t *new_slice_with_vector( vector_t *vector, size_t number );
 
 // create a new slice sharing its array with another slice. The start and beyond
@@ -77,15 +105,28 @@ extern slice_t *new_slice_from_slice( const slice_t *slice,
 
 // create a new slice identical to the given slice. The newly created slice
 // shares its array with the original slice, and has the same start and length
-// as the original slice. Modifying any of the two slice may increase the
-// shared array size, which will result in making a new array for one of the
-// slices. If however the current array size is sufficient, then the same array
-// stays shared by the two slices. SInce the array reference count is
-// incremented when the new slice is created, it is possible to free each of
-// those slices without interfering with the other.
+// as the original slice, without copying items, which makes a cheap snapshot.
+// Modifying any of the two slices makes a new array for that slice, with a
+// copy of its items, while the other slice keeps the original array. Since
+// the array reference count is incremented when the new slice is created, it
+// is possible to free each of those slices without interfering with the other.
 extern slice_t *slice_dup( const slice_t * slice );
 
-// set all items in the slice [0..len-1] to 0 or NULL pointers.
+// make sure the slice array is not shared with other slices or objects, by
+// copying the slice items into a new array if needed, before modifying items
+// through pointers (see slice_item_at and slice_data_n_len). The slice start
+// is then 0 and its length and capacity are unchanged. It returns 0 in case
+// of success or -1 otherwise (bad slice argument or no memory).
+extern int slice_unshare( slice_t *slice );
+
+// make the reference counter of the slice array atomic (see vector_set_atomic)
+// before sharing the array with slices used by other threads, which can then
+// create, grow and free their slices independently. It returns 0 in case of
+// success or -1 if the array is already shared.
+extern int slice_set_atomic( slice_t *slice );
+
+// set all items in the slice [0..len-1] to 0 or NULL pointers, giving large
+// ranges of whole pages back to the system in mapped arrays (see vector_zero).
 extern void slice_zero( slice_t *slice );
 
 // set the privately defined use field, and return its previous value, If that
@@ -111,6 +152,10 @@ extern void *slice_data_n_len( const slice_t *slice, size_t *lenp );
 // return the item size or 0 if the argument slice is NULL.
 extern size_t slice_item_size( const slice_t * slice );
 
+// return the distance in bytes between 2 consecutive items, which is the item
+// size except for padded slices, or 0 if the argument slice is NULL.
+extern size_t slice_stride( const slice_t * slice );
+
 // return a void pointer pointing to the item at position given by index
 extern void *slice_item_at( const slice_t *slice, size_t index );
 
@@ -118,7 +163,7 @@ extern void *slice_item_at( const slice_t *slice, size_t index );
 // data into the slice array at the given index. The index must be less than
 // the current slice length to succeed (use instead slice_append_item to write
 // the item at the current length). It returns 0 in case of success or -1 if
-// slice is invalid or index is not in range.
+// slice is invalid, index is not in range or a shared array cannot be copied.
 extern int slice_write_item_at( slice_t *slice,
                                 size_t index, const void *data );
 
@@ -154,11 +199,30 @@ extern int slice_swap_items( slice_t *slice, size_t index1, size_t index2 );
 // of success or -1 otherwise.
 extern int slice_append_item( slice_t *slice_t, const void *data );
 
+// make sure the slice capacity is at least number items, so that number - len
+// items can then be appended without re-allocating the array. It returns 0 in
+// case of success or -1 otherwise (bad slice argument or no memory).
+extern int slice_reserve( slice_t *slice, size_t number );
+
+// reduce the slice capacity to its current length, releasing the unused array
+// memory, unless the array is shared with other slices. It returns 0 in case
+// of success or -1 otherwise (bad slice argument or no memory).
+extern int slice_shrink_to_fit( slice_t *slice );
+
 // free the slice. If the underlying array is not shared with any other slice,
 // it is deleted as well, otherwise its reference count is just decremented. It
 // returns 0 in case of success, or -1 otherwise (bad slice argument).
 extern int slice_free( slice_t *slice );
 
+// free the slice and give its items to the caller, in a data area that must
+// be released with free, without copying the items if possible (see
+// vector_release_data). Items are moved to the beginning of the data area,
+// and the slice length is returned in *lenp if lenp is not NULL. The data
+// area holds slice_cap( slice ) items or more. It returns NULL if the slice
+// is NULL or its capacity is 0, or in case of failure (no memory), in which
+// case the slice is not freed.
+extern void *slice_release_data( slice_t *slice, size_t *lenp );
+
 // slice_process_items processes all items in slice by calling the function
 // fct (item_process_fct is defined in vector.h) passed as argument.
 // Processing the slice stops as soon as fct returns false, or at the end of
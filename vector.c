@@ -1,4 +1,6 @@
 
+#define _GNU_SOURCE             // for mremap and MAP_ANONYMOUS
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -6,53 +8,401 @@
 #include <assert.h>
 #include <string.h>
 #include <sys/types.h>
+#include <sys/mman.h>
+#include <unistd.h>
 
 #include "vector.h"
 #include "_vector.h"
 
-// The growing allocation numbers should be 2 powers
+// minimum number of items allocated when a vector grows
 #define ARRAY_MINIMUM_ALLOCATION_NUMBER     8
-// initially double previous size until threshold, then reduce increase
-#define ARRAY_ALLOCATION_NUMBER_THRESHOLD   4096
 
-static size_t get_2_power( size_t number )
+// Growing by a fixed number of items would make appending n items cost O(n^2)
+// copies. Growing by a constant factor keeps the amortized append cost in O(1)
+// whatever the vector size: the default factor 1.5 wastes less memory than
+// doubling and allows realloc to reuse previously freed blocks.
+static size_t get_grown_number( const vector_t *vector, size_t number )
 {
-    size_t allocation = ARRAY_MINIMUM_ALLOCATION_NUMBER;
+    size_t allocation = vector->number;
+    if ( allocation < ARRAY_MINIMUM_ALLOCATION_NUMBER ) {
+        allocation = ARRAY_MINIMUM_ALLOCATION_NUMBER;
+    }
     while ( number > allocation ) {
-        if ( number < ARRAY_ALLOCATION_NUMBER_THRESHOLD ) {
-            allocation *= 2;
-        } else {
-            allocation += ARRAY_ALLOCATION_NUMBER_THRESHOLD;
-        }
+        size_t grown = allocation / 100 * vector->growth +
+                       allocation % 100 * vector->growth / 100;
+        allocation = ( grown > allocation ) ? grown : allocation + 1;
     }
     return allocation;
 }
 
-extern vector_t *new_vector( size_t item_size, size_t number )
+// default huge page size used to round up VECTOR_HUGETLB mappings
+#define HUGE_PAGE_SIZE                      ( 2 * 1024 * 1024 )
+
+static size_t mapping_size( size_t bytes, unsigned int flags )
 {
-    void *data;
-    if ( number > 0 ) {
-        // Initial allocation is always as requested.
-        size_t allocation = item_size * number;
-        data = malloc( allocation );
-        if ( NULL == data ) return NULL;
+    size_t page = ( flags & VECTOR_HUGETLB ) ? HUGE_PAGE_SIZE :
+                                               (size_t)sysconf( _SC_PAGESIZE );
+    return ( bytes + page - 1 ) / page * page;
+}
+
+static void advise_mapping( void *data, size_t offset, size_t size,
+                            unsigned int flags )
+{
+#if defined( MADV_HUGEPAGE )
+    if ( flags & VECTOR_HUGE_PAGES ) {
+        madvise( data, size, MADV_HUGEPAGE );
+    }
+#endif
+#if defined( MADV_POPULATE_WRITE )
+    if ( ( flags & VECTOR_POPULATE ) && size > offset ) {
+        madvise( (uint8_t *)data + offset, size - offset, MADV_POPULATE_WRITE );
+    }
+#else
+    (void)offset;
+#endif
+}
+
+// map size bytes for a vector. With VECTOR_HUGETLB, if no huge page is
+// available the mapping falls back to normal pages, and the flag is removed.
+static void *map_data( size_t size, unsigned int *flags )
+{
+    int options = MAP_PRIVATE | MAP_ANONYMOUS;
+    if ( *flags & VECTOR_POPULATE ) options |= MAP_POPULATE;
+
+    void *data = MAP_FAILED;
+#if defined( MAP_HUGETLB )
+    if ( *flags & VECTOR_HUGETLB ) {
+        data = mmap( NULL, size, PROT_READ | PROT_WRITE,
+                     options | MAP_HUGETLB, -1, 0 );
+    }
+#endif
+    if ( MAP_FAILED == data ) {
+        *flags &= ~(unsigned int)VECTOR_HUGETLB;
+        size = mapping_size( size, *flags );
+        data = mmap( NULL, size, PROT_READ | PROT_WRITE, options, -1, 0 );
+        if ( MAP_FAILED == data ) return NULL;
+    }
+    advise_mapping( data, size, size, *flags );
+    return data;
+}
+
+// re-size the mapping of a vector to hold number items, moving pages instead
+// of copying them if possible. It returns false in case of failure (no
+// memory), in which case the vector is unchanged.
+static bool remap_data( vector_t *vector, size_t number )
+{
+    size_t size = mapping_size( vector->stride * number, vector->flags );
+    if ( size == vector->mapped ) return true;
+
+    void *data = MAP_FAILED;
+    if ( 0 == vector->mapped ) {
+        unsigned int flags = vector->flags;
+        data = map_data( size, &flags );
+        if ( NULL == data ) return false;
+        vector->flags = flags;
+        size = mapping_size( size, flags );
     } else {
-        data = NULL;
+#if defined( MREMAP_MAYMOVE )
+        data = mremap( vector->data, vector->mapped, size, MREMAP_MAYMOVE );
+#endif
+        if ( MAP_FAILED == data ) {     // e.g. huge pages: map and copy
+            unsigned int flags = vector->flags;
+            data = map_data( size, &flags );
+            if ( NULL == data ) return false;
+            size = mapping_size( size, flags );
+            memcpy( data, vector->data,
+                    ( size < vector->mapped ) ? size : vector->mapped );
+            munmap( vector->data, vector->mapped );
+            vector->flags = flags;
+        } else if ( size > vector->mapped ) {
+            advise_mapping( data, vector->mapped, size, vector->flags );
+        }
     }
+    vector->data = data;
+    vector->mapped = size;
+    return true;
+}
 
-    vector_t *vector = malloc( sizeof(vector_t) );
-    if ( NULL == vector ) {
-        free( data );
-        return NULL;
+// Vector data comes from the vector allocator. With the malloc allocator,
+// aligned data is allocated by posix_memalign. Other allocators only provide
+// the malloc alignment: aligned data then starts at offset bytes in a block
+// larger by alignment bytes.
+static inline bool is_offset_aligned( const vector_t *vector )
+{
+    return 0 != vector->alignment && vector->allocator != malloc_allocator();
+}
+
+static inline size_t block_size( const vector_t *vector, size_t size )
+{
+    return ( is_offset_aligned( vector ) ) ? size + vector->alignment : size;
+}
+
+static inline size_t align_offset( const void *block, size_t alignment )
+{
+    return (size_t)( -(uintptr_t)block & ( alignment - 1 ) );
+}
+
+// allocate size bytes for the vector data, aligned on vector->alignment if it
+// is not 0, and set the data offset in the allocated block.
+static void *alloc_data( vector_t *vector, size_t size )
+{
+    if ( 0 == vector->alignment ) {
+        vector->offset = 0;
+        return allocator_alloc( vector->allocator, size );
+    }
+    if ( ! is_offset_aligned( vector ) ) {
+        void *data;
+        if ( 0 != posix_memalign( &data, vector->alignment, size ) )
+            return NULL;
+        vector->offset = 0;
+        return data;
+    }
+    uint8_t *block = allocator_alloc( vector->allocator,
+                                      size + vector->alignment );
+    if ( NULL == block ) return NULL;
+    vector->offset = align_offset( block, vector->alignment );
+    return block + vector->offset;
+}
+
+// same as alloc_data, but the data is initialized to 0. With the malloc
+// allocator, calloc takes large blocks as fresh zero pages from the system,
+// without writing them, so that pages are only committed when they are used.
+static void *alloc_zeroed_data( vector_t *vector, size_t size )
+{
+    if ( 0 == vector->alignment && malloc_allocator() == vector->allocator ) {
+        vector->offset = 0;
+        return calloc( 1, size );
+    }
+    void *data = alloc_data( vector, size );
+    if ( NULL != data ) memset( data, 0, size );
+    return data;
+}
+
+// re-allocate the vector data to size bytes, keeping it aligned. There is no
+// aligned realloc: a block with an offset is re-allocated and its data moved
+// within the block if the offset changes, and a block from posix_memalign is
+// replaced by a new aligned block, since realloc could free it and return a
+// misaligned block that cannot be replaced if there is no memory left.
+static void *realloc_data( vector_t *vector, size_t size )
+{
+    size_t old_size = vector->stride * vector->number;
+    size_t kept = ( old_size < size ) ? old_size : size;
+    if ( 0 == vector->alignment ) {
+        return allocator_realloc( vector->allocator, vector->data,
+                                  old_size, size );
+    }
+    if ( is_offset_aligned( vector ) ) {
+        uint8_t *block = allocator_realloc( vector->allocator,
+                                (uint8_t *)vector->data - vector->offset,
+                                old_size + vector->alignment,
+                                size + vector->alignment );
+        if ( NULL == block ) return NULL;
+        size_t offset = align_offset( block, vector->alignment );
+        if ( offset != vector->offset ) {
+            memmove( block + offset, block + vector->offset, kept );
+        }
+        vector->offset = offset;
+        return block + offset;
+    }
+
+    void *new_data = alloc_data( vector, size );
+    if ( NULL == new_data ) return NULL;    // vector->data is still valid
+    memcpy( new_data, vector->data, kept );
+    free( vector->data );
+    return new_data;
+}
+
+// release the vector data, unless it is inline or mapped.
+static void free_data( vector_t *vector )
+{
+    if ( vector->data_free ) {
+        vector->data_free( vector->data );
+    } else if ( vector->flags & VECTOR_MAPPED ) {
+        if ( vector->mapped ) munmap( vector->data, vector->mapped );
+    } else if ( ! _vector_is_inline( vector ) ) {
+        allocator_free( vector->allocator,
+                        (uint8_t *)vector->data - vector->offset,
+                        block_size( vector, vector->stride * vector->number ) );
+    }
+}
+
+// With VECTOR_ATOMIC, the reference counter is updated with atomic operations
+// so that a vector can be shared and freed by multiple threads. Otherwise,
+// it is a plain counter, which is cheaper for single-threaded programs.
+#if defined( VECTOR_ATOMIC_REFCOUNT )
+#define VECTOR_DEFAULT_FLAGS        VECTOR_ATOMIC
+#else
+#define VECTOR_DEFAULT_FLAGS        0
+#endif
+
+static inline void add_reference( vector_t *vector )
+{
+    if ( vector->flags & VECTOR_ATOMIC ) {
+        __atomic_add_fetch( &vector->ref_count, 1, __ATOMIC_RELAXED );
+    } else {
+        ++vector->ref_count;
+    }
+}
+
+// remove 1 reference and return the number of remaining references. The last
+// thread releasing an atomic vector sees all previous writes to its items.
+static inline size_t remove_reference( vector_t *vector )
+{
+    if ( vector->flags & VECTOR_ATOMIC )
+        return __atomic_sub_fetch( &vector->ref_count, 1, __ATOMIC_ACQ_REL );
+    return --vector->ref_count;
+}
+
+// Small data areas are allocated together with the vector header, using the
+// flexible array inline_data, which saves an allocation and keeps the data
+// in the same cache lines as the header. A vector created without items gets
+// a small inline buffer for its first items. When an inline vector grows, its
+// data moves to a separate allocation, while the header stays in place since
+// it may be shared.
+#define VECTOR_INLINE_SIZE          64      // initial buffer if no item
+#define VECTOR_INLINE_MAX_SIZE      256     // maximum initial inline data
+
+static vector_t *alloc_vector( size_t item_size, size_t stride,
+                               size_t alignment, size_t number,
+                               const allocator_t *allocator, bool zero )
+{
+    // Initial allocation is always as requested, or a small buffer if empty.
+    size_t allocation = stride * number;
+    size_t inline_size = 0;
+    if ( 0 == alignment || alignment <= sizeof(vector_inline_t) ) {
+        if ( 0 == number && 0 != stride && stride <= VECTOR_INLINE_SIZE ) {
+            number = VECTOR_INLINE_SIZE / stride;
+            allocation = inline_size = stride * number;
+        } else if ( allocation <= VECTOR_INLINE_MAX_SIZE ) {
+            inline_size = allocation;
+        }
+    }
+
+    vector_t *vector = allocator_alloc( allocator,
+                                        sizeof(vector_t) + inline_size );
+    if ( NULL == vector ) return NULL;
+
+    vector->allocator = allocator;
+    vector->alignment = alignment;
+    vector->offset = 0;
+    vector->data_free = NULL;
+    void *data;
+    if ( inline_size || 0 == allocation ) {
+        data = ( inline_size ) ? (void *)vector->inline_data : NULL;
+        if ( zero ) memset( vector->inline_data, 0, inline_size );
+    } else {
+        data = ( zero ) ? alloc_zeroed_data( vector, allocation )
+                        : alloc_data( vector, allocation );
+        if ( NULL == data ) {
+            allocator_free( allocator, vector, sizeof(vector_t) );
+            return NULL;
+        }
     }
     vector->data = data;
     vector->ref_count = 1;
     vector->item_size = item_size;
+    vector->stride = stride;
     vector->number = number;
+    vector->growth = VECTOR_DEFAULT_GROWTH;
+    vector->mapped = 0;
+    vector->inline_size = inline_size;
+    vector->flags = VECTOR_DEFAULT_FLAGS;
+
+    return vector;
+}
 
+extern vector_t *new_vector( size_t item_size, size_t number )
+{
+    return alloc_vector( item_size, item_size, 0, number,
+                         default_allocator( ), false );
+}
+
+extern vector_t *new_vector_zeroed( size_t item_size, size_t number )
+{
+    return alloc_vector( item_size, item_size, 0, number,
+                         default_allocator( ), true );
+}
+
+extern vector_t *new_vector_with_allocator( size_t item_size, size_t number,
+                                            const allocator_t *allocator )
+{
+    if ( NULL == allocator ) allocator = default_allocator( );
+    if ( NULL == allocator->alloc ) return NULL;
+    return alloc_vector( item_size, item_size, 0, number, allocator, false );
+}
+
+static vector_t *new_vector_with_stride( size_t item_size, size_t number,
+                                         size_t alignment, bool padded )
+{
+    if ( 0 == item_size || 0 == alignment ||
+         0 != ( alignment & ( alignment - 1 ) ) ) return NULL;
+
+    size_t stride = item_size;
+    if ( padded ) {
+        stride = 1;
+        while ( stride < item_size ) stride <<= 1;
+    }
+    // posix_memalign requires at least the alignment of a pointer
+    if ( alignment < sizeof(void *) ) alignment = sizeof(void *);
+    return alloc_vector( item_size, stride, alignment, number,
+                         default_allocator( ), false );
+}
+
+extern vector_t *new_vector_aligned( size_t item_size, size_t number,
+                                     size_t alignment )
+{
+    return new_vector_with_stride( item_size, number, alignment, false );
+}
+
+extern vector_t *new_vector_padded( size_t item_size, size_t number,
+                                    size_t alignment )
+{
+    return new_vector_with_stride( item_size, number, alignment, true );
+}
+
+static vector_t *map_vector( size_t item_size, size_t number,
+                             unsigned int flags, const allocator_t *allocator )
+{
+    if ( 0 == item_size ) return NULL;
+
+    vector_t *vector = allocator_alloc( allocator, sizeof(vector_t) );
+    if ( NULL == vector ) return NULL;
+
+    vector->allocator = allocator;
+    vector->offset = 0;
+    vector->data_free = NULL;
+    vector->data = NULL;
+    vector->ref_count = 1;
+    vector->item_size = item_size;
+    vector->stride = item_size;
+    vector->alignment = 0;
+    vector->number = 0;
+    vector->growth = VECTOR_DEFAULT_GROWTH;
+    vector->mapped = 0;
+    vector->inline_size = 0;
+    vector->flags = VECTOR_MAPPED | VECTOR_DEFAULT_FLAGS |
+                    ( flags & ( VECTOR_HUGE_PAGES | VECTOR_HUGETLB |
+                                VECTOR_POPULATE | VECTOR_ATOMIC ) );
+    if ( number > 0 && ! remap_data( vector, number ) ) {
+        allocator_free( allocator, vector, sizeof(vector_t) );
+        return NULL;
+    }
+    vector->number = number;
     return vector;
 }
 
+extern vector_t *new_vector_mapped( size_t item_size, size_t number,
+                                    unsigned int flags )
+{
+    return map_vector( item_size, number, flags, default_allocator( ) );
+}
+
+extern unsigned int vector_flags( const vector_t *vector )
+{
+    if ( NULL == vector ) return 0;
+    return vector->flags;
+}
+
 extern vector_t *new_vector_from_data( const void *data,
                                        size_t item_size, size_t number )
 {
@@ -65,16 +415,114 @@ extern vector_t *new_vector_from_data( const void *data,
     return vector;
 }
 
+// buffers adopted without free function are never released
+static void keep_data( void *data )
+{
+    (void)data;
+}
+
+extern vector_t *new_vector_adopt( void *data, size_t item_size,
+                                   size_t number, data_free_fct free_fct )
+{
+    if ( NULL == data || 0 == item_size ) return NULL;
+
+    const allocator_t *allocator = default_allocator( );
+    vector_t *vector = allocator_alloc( allocator, sizeof(vector_t) );
+    if ( NULL == vector ) return NULL;
+
+    vector->allocator = allocator;
+    vector->offset = 0;
+    vector->data_free = NULL;
+    vector->data = data;
+    vector->ref_count = 1;
+    vector->item_size = item_size;
+    vector->stride = item_size;
+    vector->alignment = 0;
+    vector->number = number;
+    vector->growth = VECTOR_DEFAULT_GROWTH;
+    vector->mapped = 0;
+    vector->inline_size = 0;
+    vector->flags = VECTOR_DEFAULT_FLAGS;
+    if ( NULL == free_fct ) {
+        vector->data_free = keep_data;
+    } else if ( free != free_fct || malloc_allocator() != allocator ) {
+        vector->data_free = free_fct;
+    }
+    return vector;
+}
+
+// true if the vector data is a block that can be released by free
+static bool is_malloc_data( const vector_t *vector )
+{
+    if ( vector->data_free ) return free == vector->data_free;
+    return 0 == ( vector->flags & VECTOR_MAPPED ) &&
+           ! _vector_is_inline( vector ) &&
+           malloc_allocator() == vector->allocator;
+}
+
+extern void *vector_release_data( vector_t *vector )
+{
+    if ( NULL == vector ) return NULL;
+
+    size_t size = vector->stride * vector->number;
+    if ( 0 == size ) return NULL;
+
+    void *data = vector->data;
+    if ( 1 == _vector_references( vector ) && is_malloc_data( vector ) ) {
+        allocator_free( vector->allocator, vector,
+                        sizeof(vector_t) + vector->inline_size );
+        return data;
+    }
+    data = malloc( size );
+    if ( NULL == data ) return NULL;
+
+    memcpy( data, vector->data, size );
+    vector_free( vector );
+    return data;
+}
+
+// minimum size of a range zeroed by giving its pages back to the system
+#define ZERO_PAGES_MINIMUM_SIZE             ( 1024 * 1024 )
+
+// Zeroing a large range in a mapped vector discards the pages entirely
+// inside the range (madvise MADV_DONTNEED) instead of writing them: the next
+// access to those pages gets fresh zero pages, and pages that are not used
+// again are not committed anymore. Only the partial pages at both ends of the
+// range are written. Huge TLB pages and populated mappings are written.
+static void zero_items( vector_t *vector, size_t start, size_t len )
+{
+    uint8_t *begin = _vector_index_ptr_at( vector, start );
+    size_t size = vector->stride * len;
+#if defined( MADV_DONTNEED )
+    if ( ( vector->flags & VECTOR_MAPPED ) && size >= ZERO_PAGES_MINIMUM_SIZE &&
+         0 == ( vector->flags & ( VECTOR_HUGETLB | VECTOR_POPULATE ) ) ) {
+        uintptr_t page = (uintptr_t)sysconf( _SC_PAGESIZE );
+        uint8_t *first = (uint8_t *)( ( (uintptr_t)begin + page - 1 ) &
+                                      ~( page - 1 ) );
+        uint8_t *last = (uint8_t *)( (uintptr_t)( begin + size ) &
+                                     ~( page - 1 ) );
+        if ( first < last &&
+             0 == madvise( first, (size_t)( last - first ), MADV_DONTNEED ) ) {
+            memset( begin, 0, (size_t)( first - begin ) );
+            memset( last, 0, (size_t)( begin + size - last ) );
+            return;
+        }
+    }
+#endif
+    memset( begin, 0, size );
+}
+
 extern void vector_zero( vector_t *vector )
 {
     if ( NULL == vector ) return;
-    _vector_zero( vector );
+    zero_items( vector, 0, vector->number );
 }
 
 extern void vector_segment_zero( vector_t * vector, size_t start, size_t len )
 {
-    if ( NULL == vector ) return;
-    _vector_segment_zero( vector, start, len );
+    if ( NULL == vector || start > vector->number ||
+         len > vector->number - start ) return;
+    zero_items( vector, start, len );
 }
 
 extern void * vector_item_at( const vector_t *vector, size_t index )
@@ -123,7 +571,7 @@ extern int vector_move_items( vector_t *vector,
 
     uint8_t * dest = _vector_index_ptr_at( vector, start + offset );
     uint8_t * src = _vector_index_ptr_at( vector, start );
-    memmove( dest, src, (end-start+1) * vector->item_size );
+    memmove( dest, src, (end-start+1) * vector->stride );
     return 0;
 }
 
@@ -131,14 +579,22 @@ extern void vector_share( vector_t *vector )
 {
     if ( NULL == vector ) return;
 
-    ++vector->ref_count;
+    add_reference( vector );
+}
+
+extern int vector_set_atomic( vector_t *vector )
+{
+    if ( NULL == vector || _vector_references( vector ) != 1 ) return -1;
+
+    vector->flags |= VECTOR_ATOMIC;
+    return 0;
 }
 
 extern int vector_references( const vector_t *vector )
 {
     if ( NULL == vector ) return -1;
 
-    return vector->ref_count;
+    return (int)_vector_references( vector );
 }
 
 extern size_t vector_item_size( const vector_t * vector )
@@ -147,6 +603,18 @@ extern size_t vector_item_size( const vector_t * vector )
     return _vector_item_size( vector );
 }
 
+extern size_t vector_stride( const vector_t * vector )
+{
+    if ( NULL == vector ) return 0;
+    return _vector_stride( vector );
+}
+
+extern size_t vector_alignment( const vector_t * vector )
+{
+    if ( NULL == vector ) return 0;
+    return vector->alignment;
+}
+
 extern size_t vector_cap( const vector_t *vector )
 {
     if ( NULL == vector ) return 0;
@@ -157,39 +625,79 @@ extern void vector_free( vector_t *vector )
 {
     if ( NULL == vector ) return;
 
-    if ( vector->ref_count > 1 ) {
-        --vector->ref_count;
-    } else if ( vector->ref_count == 1 ) {
-        free( vector->data );
-        vector->ref_count = 0;
-        free( vector );
-    }
+    if ( 0 == _vector_references( vector ) || 0 != remove_reference( vector ) )
+        return;
+
+    free_data( vector );
+    allocator_free( vector->allocator, vector,
+                    sizeof(vector_t) + vector->inline_size );
 }
 
-extern vector_t *vector_grow( vector_t *vector )
+// copy len items from index start into a new vector of number items (at least
+// len) with the same layout and options, and release 1 reference from vector.
+static vector_t *copy_vector( vector_t *vector, size_t start, size_t len,
+                              size_t number )
 {
-    if ( NULL == vector ) return NULL;
+    if ( number < len ) number = len;
+    vector_t *copy;
+    if ( vector->flags & VECTOR_MAPPED ) {
+        copy = map_vector( vector->item_size, number, vector->flags,
+                           vector->allocator );
+    } else {
+        copy = alloc_vector( vector->item_size, vector->stride,
+                             vector->alignment, number, vector->allocator,
+                             false );
+    }
+    if ( NULL == copy ) return NULL;
+
+    if ( len ) {
+        memcpy( copy->data, _vector_index_ptr_at( vector, start ),
+                vector->stride * len );
+    }
+    copy->growth = vector->growth;
+    copy->flags |= vector->flags & VECTOR_ATOMIC;
+    vector_free( vector );          // remove 1 reference from parent vector
+    return copy;
+}
 
-    size_t number = get_2_power( vector->number + 1 );
+// re-allocate the vector data for number items, keeping the existing items
+// that fit in the new capacity. If the vector was shared, a new non-shared
+// vector is returned. A reference count of 1 cannot change under the caller,
+// since it is the only owner, but a shared vector may be released by other
+// owners at any time.
+static vector_t *vector_resize( vector_t *vector, size_t number )
+{
+    size_t references = _vector_references( vector );
+    if ( references == 1 && ( vector->flags & VECTOR_MAPPED ) ) {
+        if ( ! remap_data( vector, number ) ) return NULL;
+        vector->number = number;
+        return vector;
+    }
 
     void *data;
-    if ( vector->ref_count == 1 ) { // reuse the current vector with new data
-        data = realloc( vector->data, vector->item_size * number );
+    if ( references == 1 && _vector_is_inline( vector ) ) {
+        size_t size = vector->stride * number;
+        if ( size <= vector->inline_size ) {    // keep inline data
+            vector->number = number;
+            return vector;
+        }                           // move inline data to a new data area
+        data = alloc_data( vector, size );
         if ( NULL == data ) return NULL;
-    } else {                        // make separate vector with new data
-        data = malloc( vector->item_size * number );
+        memcpy( data, vector->data, vector->stride * vector->number );
+    } else if ( references == 1 && vector->data_free ) {
+        size_t size = vector->stride * number;  // move adopted data
+        data = alloc_data( vector, size );
         if ( NULL == data ) return NULL;
-
-        --vector->ref_count;        // remove 1 reference from parent vector
-
-        size_t item_size = vector->item_size;
-        vector = malloc( sizeof(vector_t) );    // switch to new vector
-        if ( NULL == vector ) {
-            free( data );
-            return NULL;
-        }
-        vector->ref_count = 1;
-        vector->item_size = item_size;
+        size_t old_size = vector->stride * vector->number;
+        memcpy( data, vector->data, ( old_size < size ) ? old_size : size );
+        vector->data_free( vector->data );
+        vector->data_free = NULL;
+    } else if ( references == 1 ) { // reuse the vector with new data
+        data = realloc_data( vector, vector->stride * number );
+        if ( NULL == data ) return NULL;
+    } else {                        // make separate vector with new data
+        size_t len = ( number < vector->number ) ? number : vector->number;
+        return copy_vector( vector, 0, len, number );
     }
     vector->data = data;
     vector->number = number;
@@ -197,6 +705,55 @@ extern vector_t *vector_grow( vector_t *vector )
     return vector;
 }
 
+extern vector_t *vector_unshare( vector_t *vector, size_t start, size_t len,
+                                 size_t number )
+{
+    if ( NULL == vector || start > vector->number ||
+         len > vector->number - start ) return NULL;
+
+    if ( ! _vector_is_shared( vector ) ) return vector;
+    return copy_vector( vector, start, len, number );
+}
+
+extern vector_t *vector_grow( vector_t *vector )
+{
+    if ( NULL == vector ) return NULL;
+
+    return vector_resize( vector, get_grown_number( vector,
+                                                    vector->number + 1 ) );
+}
+
+extern vector_t *vector_reserve( vector_t *vector, size_t number )
+{
+    if ( NULL == vector ) return NULL;
+
+    if ( number <= vector->number ) return vector;
+    return vector_resize( vector, number );
+}
+
+extern vector_t *vector_shrink_to_fit( vector_t *vector, size_t number )
+{
+    if ( NULL == vector || 0 == number ) return NULL;
+
+    if ( number >= vector->number || _vector_references( vector ) != 1 )
+        return vector;
+    return vector_resize( vector, number );
+}
+
+extern int vector_set_growth( vector_t *vector, size_t percent )
+{
+    if ( NULL == vector || percent <= 100 ) return -1;
+
+    vector->growth = percent;
+    return 0;
+}
+
+extern size_t vector_growth( const vector_t *vector )
+{
+    if ( NULL == vector ) return 0;
+    return vector->growth;
+}
+
 extern void vector_process_items( const vector_t *vector, item_process_fct fct,
                                   size_t start, size_t len, void * context )
 {
@@ -209,12 +766,12 @@ extern void vector_process_items( const vector_t *vector, item_process_fct fct,
          len = number - start;
     }
 
-    size_t item_size = vector->item_size;
-    uint8_t *ptr = ((uint8_t *)vector->data + start * item_size );
+    size_t stride = vector->stride;
+    uint8_t *ptr = ((uint8_t *)vector->data + start * stride );
 
     for ( size_t i = 0; i < len; ++i ) {
         if ( fct( i, (void *)ptr, context ) ) break;
-        ptr += item_size;
+        ptr += stride;
     }
 }
 
@@ -233,11 +790,11 @@ extern void pointer_vector_process_items( const vector_t *vector,
          len = number - start;
     }
 
-    size_t item_size = vector->item_size;
-    uint8_t *ptr = ((uint8_t *)vector->data + start * sizeof(void *));
+    size_t stride = vector->stride;
+    uint8_t *ptr = ((uint8_t *)vector->data + start * stride );
 
     for ( size_t i = 0; i < len; ++i ) {
         if ( fct( i, *(void **)ptr, context ) ) break;
-        ptr += item_size;
+        ptr += stride;
     }
 }
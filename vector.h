@@ -6,6 +6,8 @@
 #include <stdint.h>
 #include <stdbool.h>
 #include <sys/types.h>
+
+#include "alloc.h"
 /*
     Vectors are dynamic arrays. They provide constant read/update access time
     in O(1) within the array, while appending items with an amortized constant
@@ -38,19 +40,111 @@
 typedef struct vector vector_t;
 
 // create a new vector of number items, each of item_size size. The number of
-// items may be rounded up. The data area is uninitalized.
+// items may be rounded up. The data area is uninitalized. Small data areas
+// (up to 256 bytes) are allocated together with the vector in a single
+// allocation, and if number is 0 the vector gets a small buffer for its first
+// items (up to 64 bytes), so that small vectors need a single allocation.
 extern vector_t *new_vector( size_t item_size, size_t number );
 
+// same as new_vector, but the vector header and data are allocated with the
+// given allocator (see alloc.h) instead of the default allocator, including
+// when the vector grows or is copied. It returns NULL if the allocator has no
+// alloc function or in case of failure (no memory).
+extern vector_t *new_vector_with_allocator( size_t item_size, size_t number,
+                                            const allocator_t *allocator );
+
+// create a new vector of number items, each of item_size size, whose data
+// area is aligned on alignment bytes (a power of 2, e.g. 64 for a cache line
+// or an AVX-512 register), and stays aligned when the vector grows. It
+// returns NULL if alignment is not a power of 2 or in case of failure (no
+// memory). The data area is uninitalized.
+extern vector_t *new_vector_aligned( size_t item_size, size_t number,
+                                     size_t alignment );
+
+// same as new_vector_aligned, but the distance between 2 consecutive items
+// (stride) is item_size rounded up to a power of 2 (e.g. 12-byte items are
+// stored every 16 bytes), so that items never straddle an alignment boundary
+// when the item size is smaller than the alignment, and item addresses are
+// computed with a shift. Items can only be accessed through vector functions
+// or with the stride: data + index * vector_stride( vector ).
+extern vector_t *new_vector_padded( size_t item_size, size_t number,
+                                    size_t alignment );
+
+// flags for new_vector_mapped. The data area of a mapped vector is always an
+// anonymous memory mapping, re-sized by mremap without copying the items (on
+// Linux), which avoids copying and heap fragmentation for very large vectors.
+#define VECTOR_MAPPED       0x01    // always set for a mapped vector
+#define VECTOR_HUGE_PAGES   0x02    // ask for transparent huge pages (madvise)
+#define VECTOR_HUGETLB      0x04    // use explicit huge pages (MAP_HUGETLB) if
+                                    // available, or fall back to normal pages
+#define VECTOR_POPULATE     0x08    // prefault pages when mapping or growing
+#define VECTOR_ATOMIC       0x10    // atomic reference counter (any vector)
+
+// create a new vector of number items, each of item_size size, whose data
+// area is a memory mapping, with the given option flags (0 or an or'ed
+// combination of VECTOR_HUGE_PAGES, VECTOR_HUGETLB and VECTOR_POPULATE).
+// Mappings are rounded up to a page size, or a 2MB huge page size with
+// VECTOR_HUGETLB, which is wasteful for small vectors: this is intended for
+// vectors of many megabytes or more. The data area is initialized to 0 and it
+// is never allocated by an allocator (only the vector header is). It returns
+// NULL in case of failure (no memory).
+extern vector_t *new_vector_mapped( size_t item_size, size_t number,
+                                    unsigned int flags );
+
+// return the flags of a vector: the mapping flags if the vector is mapped, and
+// VECTOR_ATOMIC if its reference counter is atomic.
+extern unsigned int vector_flags( const vector_t *vector );
+
 // create a new vector of number items, each of item_size size.The number of
 // items may be rounded up. The data area is initalized with a copy of the
 // given data.
 extern vector_t *new_vector_from_data( const void *data,
                                        size_t item_size, size_t number );
 
-// set all vector elements to 0 (or NULL if pointers).
+// function releasing a data buffer adopted by a vector (e.g. free).
+typedef void (*data_free_fct)( void *data );
+
+// create a new vector of number items, each of item_size size, whose data
+// area is the given buffer, without copying it (e.g. a file read in a
+// malloc'ed buffer). The vector owns the buffer and releases it by calling
+// free_fct when the vector is deleted, or when it grows or shrinks, since
+// the items are then moved to a new data area from the default allocator.
+// If free_fct is NULL, the buffer is never released by the vector, and it
+// must stay valid as long as the vector uses it. A buffer adopted with free
+// while the default allocator is malloc is handled as if the vector had
+// allocated it (e.g. it grows by realloc). The buffer must be aligned for
+// the items. It returns NULL if data is NULL, item_size is 0 or in case of
+// failure (no memory), in which case the buffer is not released. A slice can
+// then be made of the vector (see new_slice_with_vector).
+extern vector_t *new_vector_adopt( void *data, size_t item_size,
+                                   size_t number, data_free_fct free_fct );
+
+// delete the vector and give its data area to the caller, who must release
+// it with free. The data area holds vector_cap( vector ) items, at the
+// vector stride. It is not copied if it was allocated by malloc and the
+// vector is not shared. Otherwise (small data allocated with the vector
+// header, mapped vector, other allocators or adopted buffers not released
+// by free), a copy of the data area is returned, and if the vector is shared
+// only 1 reference is released. It returns NULL if the vector is NULL or its
+// capacity is 0, or in case of failure (no memory), in which case the vector
+// is unchanged.
+extern void *vector_release_data( vector_t *vector );
+
+// same as new_vector, but the data area is initialized to 0 (or NULL
+// pointers). Large data areas are allocated by calloc with the default malloc
+// allocator, which takes fresh zero pages from the system without writing
+// them. Items added when the vector grows are not initialized. Mapped vectors
+// (see new_vector_mapped) are always initialized to 0 in the same way.
+extern vector_t *new_vector_zeroed( size_t item_size, size_t number );
+
+// set all vector elements to 0 (or NULL if pointers). In mapped vectors,
+// large ranges of whole pages are given back to the system instead of being
+// written (madvise MADV_DONTNEED), so that they are zero-filled again on
+// first access, and pages not accessed anymore do not use memory.
 extern void vector_zero( vector_t *vector );
 
-// set all elements of the segment defined by start and len to 0 (or NULL);
+// set all elements of the segment defined by start and len to 0 (or NULL), as
+// vector_zero does, if the segment is within the vector capacity.
 extern void vector_segment_zero( vector_t * vector, size_t start, size_t len );
 
 // delete a vector if its reference count is 1, otherwise just decrement its
@@ -59,23 +153,83 @@ extern void vector_segment_zero( vector_t * vector, size_t start, size_t len );
 extern void vector_free( vector_t *vector );
 
 // let multiple objects share a vector by incrementing its reference counter.
-// Note that this is not multi-thread safe.
+// Note that this is not multi-thread safe, unless the reference counter is
+// atomic (see vector_set_atomic).
 extern void vector_share( vector_t *vector );
 
+// make the vector reference counter atomic, so that the vector can be shared
+// with other threads, which may then call vector_share, vector_free,
+// vector_grow, vector_reserve or vector_unshare concurrently on their own
+// references. Growing a shared vector always creates a new vector, so that
+// each thread gets its own copy, but writing items in a shared vector is not
+// synchronized (slices copy a shared vector before modifying it). This
+// must be done before the vector is shared: it returns 0 in case of success
+// or -1 if the vector is already shared. All vectors are created atomic if
+// the library is built with VECTOR_ATOMIC_REFCOUNT defined (for example
+// make GDEFS=-DVECTOR_ATOMIC_REFCOUNT). Atomic counters are slightly slower.
+extern int vector_set_atomic( vector_t *vector );
+
 // how many references point to the same vector?
 extern int vector_references( const vector_t *vector );
 
 // return the item size 0r 0 if the argument vector is NULL.
 extern size_t vector_item_size( const vector_t * vector );
 
+// return the distance in bytes between 2 consecutive items, which is the item
+// size except for padded vectors, or 0 if the argument vector is NULL.
+extern size_t vector_stride( const vector_t * vector );
+
+// return the data alignment given to new_vector_aligned or new_vector_padded,
+// or 0 if the vector was created with the default malloc alignment.
+extern size_t vector_alignment( const vector_t * vector );
+
 // return the current vector capacity, i.e. how may items can written in it.
 extern size_t vector_cap( const vector_t *vector );
 
+// default capacity growth factor in percent of the current capacity
+#define VECTOR_DEFAULT_GROWTH   150
+
 // grow the vector, increasing its capacity by allocating a new data area.
-// If the vector was shared (reference counter > 1) then a new non-shared
-// vector is created and returned. Otherwise the same vector is returned.
+// The new capacity is the current capacity multiplied by the vector growth
+// factor (see vector_set_growth), so that appending n items one at a time
+// costs O(n) in total. If the vector was shared (reference counter > 1) then
+// a new non-shared vector is created with a copy of the existing items and
+// returned. Otherwise the same vector is returned. It returns NULL in case of
+// failure (no memory).
 extern vector_t *vector_grow( vector_t *vector );
 
+// make sure the vector capacity is at least number items, allocating a new
+// data area at once if needed (e.g. before appending a known number of items,
+// instead of growing multiple times). Like vector_grow, it returns the same
+// vector or a new non-shared vector if it was shared, or NULL in case of
+// failure (no memory).
+extern vector_t *vector_reserve( vector_t *vector, size_t number );
+
+// reduce the vector capacity to number items, if it is larger, in order to
+// release unused memory. Items beyond number are lost. The capacity of a
+// shared vector is not modified. It returns the vector or NULL if number is 0
+// or in case of failure (no memory), in which case the vector is unchanged.
+extern vector_t *vector_shrink_to_fit( vector_t *vector, size_t number );
+
+// copy-on-write support: return a vector that the caller owns alone, before
+// modifying it. If the vector is not shared, the same vector is returned.
+// Otherwise, len items from index start in the shared vector are copied at
+// index 0 in a new vector with the same item layout and options, and a
+// capacity of number items (at least len), which is returned, and the caller
+// reference to the shared vector is released. It returns NULL if start + len
+// is beyond the vector capacity or in case of failure (no memory), in which
+// case the shared vector is unchanged.
+extern vector_t *vector_unshare( vector_t *vector, size_t start, size_t len,
+                                 size_t number );
+
+// set the factor used by vector_grow to increase the vector capacity, in
+// percent of the current capacity (e.g. 200 to double the capacity). It
+// returns 0 in case of success or -1 if percent is not greater than 100.
+extern int vector_set_growth( vector_t *vector, size_t percent );
+
+// return the vector growth factor in percent, or 0 if the vector is NULL.
+extern size_t vector_growth( const vector_t *vector );
+
 // provide a pointer to the value at a given index in the vector. Return NULL
 // if the index is equal or larger than its length.
 extern void * vector_item_at( const vector_t *vector, size_t index );
@@ -0,0 +1,156 @@
+
+/*
+    Vector append benchmark.
+
+    It appends up to N 32-bit items (10^8 by default) one at a time to a slice,
+    and prints the average time per append at each power of 10, for:
+
+    - the default geometric growth (x1.5, see VECTOR_DEFAULT_GROWTH),
+    - a doubling growth (vector_set_growth( vector, 200 )),
+    - a single slice_reserve of N items before appending,
+    - a fixed growth of 4096 items, which was the policy of vector_grow for
+      large vectors and is emulated by calling slice_reserve when the slice
+      is full,
+    - a mapped vector (new_vector_mapped), growing with mremap,
+    - a mapped vector with transparent huge pages (VECTOR_HUGE_PAGES).
+
+    With geometric growth, the time per append stays constant (amortized O(1))
+    as the number of items grows. With a fixed growth, each re-allocation may
+    copy the whole array, which makes appending O(N^2). Note that for large
+    blocks, the glibc realloc moves pages with mremap instead of copying them,
+    which hides most of that cost on Linux, but not the number of realloc
+    calls (N / 4096 instead of about log1.5(N)).
+
+    Then it measures the time to create a small slice, append a few 32-bit
+    items to it and free it, for slices whose items fit in the small inline
+    buffer allocated with the vector, and for slices that outgrow it.
+
+    Build with: make OPTIMIZE=-O2 vector_bench
+    Run with:   ./vector_bench [N]
+*/
+
+#define _POSIX_C_SOURCE 199309L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <time.h>
+
+#include "vector.h"
+#include "slice.h"
+
+#define DEFAULT_ITEMS       100000000
+#define FIXED_GROWTH        4096
+#define SMALL_SLICES        10000000
+
+typedef enum { GEOMETRIC, DOUBLING, RESERVE, FIXED, MAPPED, HUGE } policy_t;
+
+static const char *policy_names[] = { "x1.5 (default)", "x2", "reserve",
+                                      "+4096 items", "mapped",
+                                      "mapped huge" };
+
+static double now( void )
+{
+    struct timespec ts;
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+static void append( policy_t policy, size_t n )
+{
+    slice_t *slice = new_slice( sizeof(uint32_t), 0 );
+    if ( NULL == slice ) return;
+
+    // the vector is not accessible from the slice: create it explicitly
+    if ( DOUBLING == policy || MAPPED == policy || HUGE == policy ) {
+        vector_t *vector;
+        if ( DOUBLING == policy ) {
+            vector = new_vector( sizeof(uint32_t), 0 );
+            vector_set_growth( vector, 200 );
+        } else {
+            vector = new_vector_mapped( sizeof(uint32_t), 0,
+                                    ( HUGE == policy ) ? VECTOR_HUGE_PAGES : 0 );
+        }
+        slice_free( slice );
+        slice = new_slice_with_vector( vector, 0 );
+        if ( NULL == slice ) return;
+    }
+
+    printf( "%-16s", policy_names[policy] );
+    double start = now(), last = start;
+    size_t checkpoint = 1000, previous = 0;
+
+    if ( RESERVE == policy && 0 != slice_reserve( slice, n ) ) {
+        printf( " no memory\n" );
+        slice_free( slice );
+        return;
+    }
+    for ( size_t i = 0; i < n; ++i ) {
+        if ( FIXED == policy && slice_len( slice ) == slice_cap( slice ) ) {
+            if ( 0 != slice_reserve( slice, slice_cap( slice ) + FIXED_GROWTH ) )
+                break;
+        }
+        uint32_t item = (uint32_t)i;
+        if ( 0 != slice_append_item( slice, &item ) ) {
+            printf( " no memory" );
+            break;
+        }
+        if ( i + 1 == checkpoint || i + 1 == n ) {
+            double t = now();
+            printf( " %8.2f", ( t - last ) * 1e9 / (double)( i + 1 - previous ) );
+            fflush( stdout );
+            last = t;
+            previous = i + 1;
+            checkpoint *= 10;
+        }
+    }
+    printf( " | %.3f s\n", now() - start );
+    slice_free( slice );
+}
+
+static void small_slices( size_t items )
+{
+    uint64_t sum = 0;
+    double start = now();
+    for ( size_t i = 0; i < SMALL_SLICES; ++i ) {
+        slice_t *slice = new_slice( sizeof(uint32_t), 0 );
+        for ( size_t j = 0; j < items; ++j ) {
+            uint32_t item = (uint32_t)( i + j );
+            slice_append_item( slice, &item );
+        }
+        sum += *(uint32_t *)slice_item_at( slice, items - 1 );
+        slice_free( slice );
+    }
+    double elapsed = now() - start;
+    printf( "%8zu %12.1f   (%llu)\n", items,
+            elapsed * 1e9 / SMALL_SLICES, (unsigned long long)sum );
+}
+
+int main( int argc, char **argv )
+{
+    size_t n = ( argc > 1 ) ? strtoull( argv[1], NULL, 10 ) : DEFAULT_ITEMS;
+    if ( n < 1000 ) n = 1000;
+
+    printf( "ns per append between successive powers of 10, up to %zu items\n",
+            n );
+    printf( "%-16s", "growth" );
+    for ( size_t c = 1000; c < n * 10; c *= 10 ) {
+        printf( " %8zu", ( c <= n ) ? c : n );
+        if ( c >= n ) break;
+    }
+    printf( "\n" );
+
+    append( GEOMETRIC, n );
+    append( DOUBLING, n );
+    append( RESERVE, n );
+    append( FIXED, n );
+    append( MAPPED, n );
+    append( HUGE, n );
+
+    printf( "\nns per small slice creation, appends and free\n" );
+    printf( "%8s %12s\n", "items", "ns" );
+    small_slices( 4 );
+    small_slices( 16 );
+    small_slices( 64 );
+    return 0;
+}
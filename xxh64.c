@@ -0,0 +1,114 @@
+
+#include <string.h>
+
+#include "xxh64.h"
+
+#define PRIME64_1   0x9e3779b185ebca87
+#define PRIME64_2   0xc2b2ae3d27d4eb4f
+#define PRIME64_3   0x165667b19e3779f9
+#define PRIME64_4   0x85ebca77c2b2ae63
+#define PRIME64_5   0x27d4eb2f165667c5
+
+#define STRIPE_SIZE 32              // 4 lanes of 8 bytes
+
+static inline uint64_t rotl64( uint64_t x, int r )
+{
+    return ( x << r ) | ( x >> (64 - r) );
+}
+
+static inline uint64_t read64( const uint8_t *data )
+{
+    uint64_t word;
+    memcpy( &word, data, 8 );       // unaligned read
+#if defined( __BYTE_ORDER__ ) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    word = __builtin_bswap64( word );
+#endif
+    return word;
+}
+
+static inline uint32_t read32( const uint8_t *data )
+{
+    uint32_t word;
+    memcpy( &word, data, 4 );
+#if defined( __BYTE_ORDER__ ) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    word = __builtin_bswap32( word );
+#endif
+    return word;
+}
+
+static inline uint64_t xxh64_round( uint64_t acc, uint64_t input )
+{
+    acc += input * PRIME64_2;
+    acc = rotl64( acc, 31 );
+    return acc * PRIME64_1;
+}
+
+static inline uint64_t xxh64_merge( uint64_t hash, uint64_t acc )
+{
+    hash ^= xxh64_round( 0, acc );
+    return hash * PRIME64_1 + PRIME64_4;
+}
+
+static inline uint64_t _xxh64( uint64_t seed, const uint8_t *data, size_t len )
+{
+    const uint8_t *end = data + len;
+    uint64_t hash;
+
+    if ( len >= STRIPE_SIZE ) {     // 4 independent accumulators
+        const uint8_t *limit = end - STRIPE_SIZE;
+        uint64_t v1 = seed + PRIME64_1 + PRIME64_2;
+        uint64_t v2 = seed + PRIME64_2;
+        uint64_t v3 = seed;
+        uint64_t v4 = seed - PRIME64_1;
+
+        do {
+            v1 = xxh64_round( v1, read64( data ) );
+            v2 = xxh64_round( v2, read64( data + 8 ) );
+            v3 = xxh64_round( v3, read64( data + 16 ) );
+            v4 = xxh64_round( v4, read64( data + 24 ) );
+            data += STRIPE_SIZE;
+        } while ( data <= limit );
+
+        hash = rotl64( v1, 1 ) + rotl64( v2, 7 ) +
+               rotl64( v3, 12 ) + rotl64( v4, 18 );
+        hash = xxh64_merge( hash, v1 );
+        hash = xxh64_merge( hash, v2 );
+        hash = xxh64_merge( hash, v3 );
+        hash = xxh64_merge( hash, v4 );
+    } else {
+        hash = seed + PRIME64_5;
+    }
+    hash += (uint64_t)len;
+
+    while ( data + 8 <= end ) {     // remaining 8-byte words
+        hash ^= xxh64_round( 0, read64( data ) );
+        hash = rotl64( hash, 27 ) * PRIME64_1 + PRIME64_4;
+        data += 8;
+    }
+    if ( data + 4 <= end ) {
+        hash ^= (uint64_t)read32( data ) * PRIME64_1;
+        hash = rotl64( hash, 23 ) * PRIME64_2 + PRIME64_3;
+        data += 4;
+    }
+    while ( data < end ) {
+        hash ^= (uint64_t)(*data++) * PRIME64_5;
+        hash = rotl64( hash, 11 ) * PRIME64_1;
+    }
+
+    hash ^= hash >> 33;             // final avalanche
+    hash *= PRIME64_2;
+    hash ^= hash >> 29;
+    hash *= PRIME64_3;
+    hash ^= hash >> 32;
+    return hash;
+}
+
+uint64_t xxh64_append( uint64_t hash, uint8_t *data, size_t len )
+{
+    return _xxh64( hash, data, len );
+}
+
+uint64_t xxh64( uint8_t *data, size_t len )
+{
+    return _xxh64( 0, data, len );
+}
@@ -0,0 +1,28 @@
+
+#include <stdlib.h>
+#include <stdint.h>
+
+/*
+    XXH64 hash implementation (xxHash, 64-bit version)
+
+    Original algorithm by Yann Collet, https://github.com/Cyan4973/xxHash
+    (BSD 2-Clause license). This is an independent implementation producing
+    the same hash values as the reference XXH64.
+
+    Unlike FNV, which runs one dependent multiply (or shift-add chain) per byte,
+    XXH64 consumes 32-byte stripes with 4 independent 64-bit accumulators, so
+    that the 4 multiply chains overlap in the CPU pipeline. It is well suited
+    for long keys (hundreds of bytes or more), while keeping good avalanche
+    properties. For very short keys, fxhash_64 (see fx.h) is usually faster.
+
+    Data is always read as little-endian words, so that the hash values are
+    the same on all hosts.
+*/
+
+// hash data, using a previously calculated hash value as seed. Unlike the FNV
+// append function, the result is not the hash of the concatenated data, but
+// it is a valid way to chain multiple fields in a single hash value.
+uint64_t xxh64_append( uint64_t hash, uint8_t *data, size_t len );
+
+// calculate the 64-bit XXH64 hash on a buffer (with seed 0)
+uint64_t xxh64( uint8_t *data, size_t len );